@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "BatchSimulator.h"
+#include "Gains.h"
+#include "PID.h"
+
+// Usage: batch_bench [track]. A 16 x 16 grid of steering gains driven
+// car by car with Simulator and PID, then all at once with BatchSimulator and PIDBank.
+int main(int argc, char *argv[]) {
+    Track track = argc > 1 ? Track::Load(argv[1]) : Track::Loop();
+    if (track.Size() == 0) {
+        std::cerr << "can't read track" << std::endl;
+        return 1;
+    }
+
+    std::vector<Gains> gains;
+    for (int a = 0; a < 16; a++) {
+        for (int b = 0; b < 16; b++) gains.push_back({0.05 + 0.05 * a, 0.0, 0.5 + 0.5 * b});
+    }
+    int frames = 2000;
+    SimConfig config;
+    SpeedControl speed;
+
+    std::vector<EpisodeResult> scalar;
+    auto start = std::chrono::steady_clock::now();
+    Simulator sim(track, config);
+    PID pid;
+    for (auto &g : gains) {
+        sim.Reset();
+        pid.Init(g.Kp, g.Ki, g.Kd);
+        speed.Reset();
+        scalar.push_back(runEpisode(sim, pid, speed, frames));
+    }
+    auto end = std::chrono::steady_clock::now();
+    double scalar_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    BatchSimulator batch(track, config, gains.size());
+    PIDBank bank(gains.size());
+    for (size_t k = 0; k < gains.size(); k++) bank.Init(k, gains[k].Kp, gains[k].Ki, gains[k].Kd);
+    std::vector<EpisodeResult> lanes = runBatchEpisode(batch, bank, speed, frames);
+    end = std::chrono::steady_clock::now();
+    double batch_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    double max_diff = 0;
+    size_t disagree = 0, completed = 0;
+    for (size_t k = 0; k < gains.size(); k++) {
+        max_diff = std::fmax(max_diff, std::fabs(scalar[k].total_error - lanes[k].total_error));
+        disagree += scalar[k].off_track != lanes[k].off_track;
+        completed += !lanes[k].off_track;
+    }
+
+    double updates = double(gains.size()) * frames;
+    std::cout << gains.size() << " cars x " << frames << " frames" << std::endl;
+    std::cout << "Simulator + PID:        " << scalar_ms << " ms, " << updates / scalar_ms / 1e3 << " M frames/s"
+              << std::endl;
+    std::cout << "BatchSimulator + PIDBank: " << batch_ms << " ms, " << updates / batch_ms / 1e3 << " M frames/s"
+              << std::endl;
+    std::cout << completed << " stayed on the track; max total error difference " << max_diff << ", "
+              << disagree << " disagree on leaving the track" << std::endl;
+    return 0;
+}
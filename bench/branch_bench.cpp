@@ -0,0 +1,102 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "ErrorStats.h"
+#include "Simulator.h"
+
+// The steering controller main() uses, with a stage that has state of its own.
+using Steering = Controller<Terms::PD, double, ErrorStatistics<double>, Saturation<double>>;
+
+const double kKp = 0.3, kKd = 3.5;
+
+// Candidate k's Kd, around main()'s.
+static double candidateKd(int k) {
+    return 2.0 + 0.05 * k;
+}
+
+static bool same(const EpisodeResult &a, const EpisodeResult &b) {
+    return a.frames == b.frames && a.total_error == b.total_error && a.mean_speed == b.mean_speed &&
+           a.distance == b.distance && a.off_track == b.off_track;
+}
+
+// Usage: branch_bench [track]. Candidates evaluated over the same stretch of a
+// lap, by replaying the lap up to it for each one and by branching from a
+// snapshot taken there once.
+int main(int argc, char *argv[]) {
+    Track track = argc > 1 ? Track::Load(argv[1]) : Track::Loop();
+    if (track.Size() == 0) {
+        std::cerr << "can't read track" << std::endl;
+        return 1;
+    }
+
+    SimConfig config;
+    config.cte_noise = 0.05; // the noise generator is part of what gets copied
+    const int lead = 4000, frames = 500, candidates = 64;
+
+    // the lead-in, and the branch point at its end
+    Simulator sim(track, config);
+    Steering pid;
+    pid.Init(kKp, 0, kKd);
+    SpeedControl speed;
+    runEpisode(sim, pid, speed, lead);
+    if (sim.OffTrack()) {
+        std::cerr << "left the track during the lead-in" << std::endl;
+        return 1;
+    }
+    const Branch<Steering> branch{sim, pid.Snapshot(), speed.Snapshot()};
+
+    // one unbroken run of lead + frames with main()'s gains...
+    Simulator whole(track, config);
+    Steering whole_pid;
+    whole_pid.Init(kKp, 0, kKd);
+    SpeedControl whole_speed;
+    runEpisode(whole, whole_pid, whole_speed, lead + frames);
+
+    // ...is what restoring the snapshot and updating from there gives, noise included
+    Simulator resumed = branch.sim;
+    Steering restored;
+    restored.Init(kKp, 0, kKd);
+    restored.Restore(branch.steering);
+    SpeedControl restored_speed;
+    restored_speed.Restore(branch.speed);
+    runEpisode(resumed, restored, restored_speed, frames);
+    bool exact = restored.err == whole_pid.err && resumed.Distance() == whole.Distance() &&
+                 resumed.Observe().cte == whole.Observe().cte &&
+                 restored_speed.MeanSpeed() == whole_speed.MeanSpeed() &&
+                 restored.Get<ErrorStatistics<double>>().stats.Mean() ==
+                 whole_pid.Get<ErrorStatistics<double>>().stats.Mean();
+    std::cout << "lead-in + restore + update " << (exact ? "reproduces" : "DIFFERS FROM") << " an unbroken run"
+              << std::endl;
+
+    std::vector<EpisodeResult> replayed(candidates), branched(candidates);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < candidates; k++) {
+        Simulator s(track, config);
+        Steering c;
+        c.Init(kKp, 0, kKd);
+        SpeedControl v;
+        runEpisode(s, c, v, lead);
+        c.Kd = candidateKd(k);
+        replayed[k] = runEpisode(s, c, v, frames);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k = 0; k < candidates; k++) {
+        Simulator s = branch.sim;
+        Steering c;
+        c.Init(kKp, 0, candidateKd(k));
+        c.Restore(branch.steering);
+        SpeedControl v;
+        v.Restore(branch.speed);
+        branched[k] = runEpisode(s, c, v, frames);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    int mismatched = 0;
+    for (int k = 0; k < candidates; k++) mismatched += !same(replayed[k], branched[k]);
+    auto ms = [](std::chrono::steady_clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << candidates << " candidates x " << frames << " frames after a " << lead << " frame lead-in" << std::endl;
+    std::cout << "replaying the lead-in: " << ms(t1 - t0) << " ms" << std::endl;
+    std::cout << "branching a snapshot:  " << ms(t2 - t1) << " ms" << std::endl;
+    std::cout << mismatched << " candidates differ between the two" << std::endl;
+    return exact && mismatched == 0 ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+#include <chrono>
+#include <iostream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "Clock.h"
+
+template<typename F>
+static double nsPerCall(F now) {
+    const int calls = 2000000;
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) sink += now();
+    auto end = std::chrono::steady_clock::now();
+    if (sink == 42) std::cout << "";
+    return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+int main() {
+    auto &tsc = TscClock::Instance();
+
+    std::cout << "clock_gettime (vDSO):    " << nsPerCall(monotonicNanos) << " ns" << std::endl;
+    std::cout << "clock_gettime (syscall): " << nsPerCall([] {
+        timespec ts;
+        syscall(SYS_clock_gettime, CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_nsec);
+    }) << " ns" << std::endl;
+    std::cout << "steady_clock::now:       " << nsPerCall([] {
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }) << " ns" << std::endl;
+    if (tsc.Available()) {
+        std::cout << "calibrated TSC:          " << nsPerCall([&tsc] { return tsc.Nanos(); }) << " ns" << std::endl;
+        std::cout << "TSC - monotonic offset:  "
+                  << static_cast<int64_t>(tsc.Nanos() - monotonicNanos()) << " ns" << std::endl;
+    } else {
+        std::cout << "calibrated TSC:          not available (no invariant TSC)" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef FRAMES_H
+#define FRAMES_H
+
+#include <string>
+#include <vector>
+
+/*
+* Frames captured from the simulator, socket.io prefix included.
+*/
+inline std::vector<std::string> recordedFrames() {
+    return {
+        "42[\"telemetry\",{\"cte\":\"0.7598\",\"speed\":\"0.0000\",\"steering_angle\":\"0.0000\",\"throttle\":\"0.0000\"}]",
+        "42[\"telemetry\",{\"cte\":\"0.4105\",\"speed\":\"12.3510\",\"steering_angle\":\"-4.5000\",\"throttle\":\"1.0000\"}]",
+        "42[\"telemetry\",{\"cte\":\"-0.1187\",\"speed\":\"29.8705\",\"steering_angle\":\"3.1240\",\"throttle\":\"1.0000\"}]",
+        "42[\"telemetry\",{\"cte\":\"1.0412\",\"speed\":\"27.5021\",\"steering_angle\":\"-15.0000\",\"throttle\":\"-1.0000\"}]",
+    };
+}
+
+/*
+* Other events of our simulator fork, with the fields a consumer would pull.
+*/
+struct EventFrame {
+    std::string frame;
+    std::vector<std::string> fields;
+};
+
+inline std::vector<EventFrame> recordedEventFrames() {
+    std::string ptsx, ptsy;
+    for (int k = 0; k < 24; k++) {
+        ptsx += (k ? "," : "") + std::to_string(-32.16173 + 7.5 * k);
+        ptsy += (k ? "," : "") + std::to_string(113.361 - 0.25 * k * k);
+    }
+    return {
+        {"42[\"waypoints\",{\"ptsx\":[" + ptsx + "],\"ptsy\":[" + ptsy + "],\"x\":\"-40.62\",\"y\":\"108.73\"}]",
+         {"x", "y"}},
+        {"42[\"lap\",{\"lap\":\"3\",\"time\":\"84.2711\",\"best\":\"81.9036\",\"note\":\"sector \\\"2\\\" slow\"}]",
+         {"lap", "time"}},
+        {recordedFrames()[2], {"cte", "speed", "steering_angle"}},
+    };
+}
+
+#endif /* FRAMES_H */
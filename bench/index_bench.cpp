@@ -0,0 +1,104 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "json.hpp"
+#include "JsonIndex.h"
+#include "Telemetry.h"
+#include "frames.h"
+
+using json = nlohmann::json;
+
+// Full DOM, then the fields looked up and converted.
+static double pullDom(std::string_view s, const std::vector<std::string> &fields) {
+    auto j = json::parse(s.begin(), s.end());
+    double sum = 0;
+    for (auto &f : fields) sum += std::stod(j[1][f].get_ref<const std::string &>());
+    return sum;
+}
+
+// Stage 1 index, then on-demand access to the same fields.
+static double pullIndex(JsonIndex &index, std::string_view s, const std::vector<std::string> &fields) {
+    JsonIndex::Value root, data, v;
+    double sum = 0, x;
+    if (!index.Build(s) || !index.Root(root) || !index.Element(root, 1, data)) return 0;
+    for (auto &f : fields) {
+        if (index.Field(data, f, v) && JsonIndex::Number(v, x)) sum += x;
+    }
+    return sum;
+}
+
+// The lazy field access of TelemetryView on a frame with fields past the three
+// decoded eagerly. Prints what failed, if anything.
+static bool checkTelemetryView() {
+    std::string_view frame = "[\"telemetry\",{\"cte\":\"0.5\",\"speed\":\"10\",\"steering_angle\":\"0\","
+                             "\"x\":\"3.5\",\"throttle\":0.25,\"image\":\"a\\\"b\\\\c\","
+                             "\"a_field_name_longer_than_24\":\"7\"}]";
+    JsonIndex index;
+    Telemetry t;
+    std::string_view object;
+    if (!decodeTelemetry(frame, t, &object)) {
+        std::cerr << "TelemetryView: frame not decoded" << std::endl;
+        return false;
+    }
+    TelemetryView view(t, object, index);
+    bool ok = true;
+    auto expect = [&ok](bool pass, const char *what) {
+        if (!pass) std::cerr << "TelemetryView: " << what << std::endl;
+        ok = ok && pass;
+    };
+
+    double d = 0;
+    expect(view.Number("x", d) && d == 3.5, "first lookup");
+    d = 0;
+    expect(view.Number("x", d) && d == 3.5, "cached lookup");
+
+    // the cache must not keep the caller's buffer: reuse it for another key
+    std::string key = "throttle";
+    expect(view.Number(key, d) && d == 0.25, "key from a std::string");
+    key.replace(0, key.size(), "missing!");
+    expect(!view.Number(key, d), "std::string key reused after a lookup");
+    expect(view.Number(std::string("throttle"), d) && d == 0.25, "key from a temporary");
+
+    expect(!view.Number("missing", d) && !view.Number("missing", d), "missing key");
+    expect(view.Number("a_field_name_longer_than_24", d) && d == 7 &&
+           view.Number("a_field_name_longer_than_24", d) && d == 7, "key longer than the cache holds");
+
+    std::string_view text;
+    expect(view.String("image", text) && text == "a\\\"b\\\\c", "escaped string");
+    expect(!view.String("throttle", text), "String on a number");
+    return ok;
+}
+
+template<typename F>
+static double nsPerFrame(int rounds, F pull) {
+    double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) sink += pull();
+    auto end = std::chrono::steady_clock::now();
+    if (sink == 42.4242) std::cout << "";
+    return std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+}
+
+int main() {
+    if (!checkTelemetryView()) return 1;
+    std::cout << "TelemetryView lookups check out" << std::endl;
+
+    JsonIndex index;
+    int rounds = 50000;
+    for (auto &e : recordedEventFrames()) {
+        std::string_view s = e.frame;
+        s = s.substr(s.find('['));
+
+        if (pullDom(s, e.fields) != pullIndex(index, s, e.fields)) {
+            std::cerr << "mismatch on " << s << std::endl;
+            return 1;
+        }
+        double dom = nsPerFrame(rounds, [&] { return pullDom(s, e.fields); });
+        double idx = nsPerFrame(rounds, [&] { return pullIndex(index, s, e.fields); });
+
+        std::cout << s.substr(0, s.find(',')) << " (" << s.size() << " bytes): json.hpp "
+                  << dom << " ns, JsonIndex " << idx << " ns, " << dom / idx << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "PID.h"
+#include "PIDBank.h"
+
+// Deterministic per-lane cross track error, different phase and amplitude per lane.
+static void fillCte(std::vector<double> &cte, int step) {
+    for (size_t k = 0; k < cte.size(); k++) {
+        cte[k] = (0.5 + 0.001 * k) * std::sin(0.05 * step + 0.37 * k) + ((step + k) % 7 == 0 ? 1e-3 : 0);
+    }
+}
+
+int main() {
+    const size_t lanes = 4096;
+    const int steps = 2000;
+
+    PIDBank bank(lanes);
+    std::vector<PID> pids(lanes);
+    for (size_t k = 0; k < lanes; k++) {
+        double kp = 0.05 + 0.0001 * k, ki = (k % 3) * 0.001, kd = 1.0 + 0.001 * k;
+        bank.Init(k, kp, ki, kd);
+        pids[k].Init(kp, ki, kd);
+    }
+
+    // lane-for-lane check against PID::UpdateError
+    std::vector<double> cte(lanes), steer(lanes);
+    for (int i = 0; i < 200; i++) {
+        fillCte(cte, i);
+        bank.UpdateError(cte.data(), steer.data());
+        for (size_t k = 0; k < lanes; k++) {
+            double expected = pids[k].UpdateError(cte[k]);
+            if (std::memcmp(&expected, &steer[k], sizeof(double)) != 0) {
+                std::cerr << "lane " << k << " step " << i << ": " << steer[k] << " != " << expected << std::endl;
+                return 1;
+            }
+        }
+    }
+    for (size_t k = 0; k < lanes; k++) {
+        if (bank.TotalError(k) != pids[k].TotalError()) {
+            std::cerr << "lane " << k << ": total error differs" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<double>> trace(steps, std::vector<double>(lanes));
+    for (int i = 0; i < steps; i++) fillCte(trace[i], i);
+
+    double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++) {
+        for (size_t k = 0; k < lanes; k++) sink += pids[k].UpdateError(trace[i][k]);
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++) {
+        bank.UpdateError(trace[i].data(), steer.data());
+        sink += steer[i % lanes];
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (sink == 42.4242) std::cout << "";
+
+    double updates = double(lanes) * steps;
+    double scalar = updates / std::chrono::duration<double>(mid - start).count();
+    double batched = updates / std::chrono::duration<double>(end - mid).count();
+    std::cout << "lanes match PID::UpdateError" << std::endl;
+    std::cout << "PID:     " << scalar / 1e6 << " M controller updates/sec" << std::endl;
+    std::cout << "PIDBank: " << batched / 1e6 << " M controller updates/sec" << std::endl;
+    return 0;
+}
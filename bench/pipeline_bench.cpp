@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "PIDT.h"
+#include "GainSchedule.h"
+#include "ErrorStats.h"
+
+using Plain = PIDT<Terms::PID>;
+using FullChain = Controller<Terms::PID, double, DerivativeLowPass<double>, AntiWindup<double>, RateLimit<double>,
+        Saturation<double>>;
+using WithStats = Controller<Terms::PID, double, ErrorStatistics<double>, Saturation<double>>;
+
+// Each update depends on the previous output, so this measures the latency of one update.
+template<typename C>
+static double nsPerUpdate(C &c, const std::vector<double> &trace, int rounds) {
+    double steer = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (double cte : trace) steer = c.UpdateError(cte + 0.01 * steer);
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (steer == 42.4242) std::cout << "";
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(rounds) * trace.size());
+}
+
+// The same chain with the gains looked up from speed before every update, as main() does.
+template<typename C>
+static double nsPerScheduledUpdate(C &c, const GainSchedule &schedule, const std::vector<double> &trace, int rounds) {
+    double steer = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t k = 0; k < trace.size(); k++) {
+            Gains g = schedule.At(25 + 20 * trace[k]);
+            c.Kp = g.Kp;
+            c.Ki = g.Ki;
+            c.Kd = g.Kd;
+            steer = c.UpdateError(trace[k] + 0.01 * steer);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (steer == 42.4242) std::cout << "";
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(rounds) * trace.size());
+}
+
+int main() {
+    std::vector<double> trace;
+    for (int i = 0; i < 4096; i++) trace.push_back(0.8 * std::sin(0.01 * i) + 0.1 * std::sin(0.37 * i));
+
+    Plain plain;
+    plain.Init(0.3, 0.001, 3.5);
+
+    FullChain chain;
+    chain.Init(0.3, 0.001, 3.5);
+    chain.Get<DerivativeLowPass<double>>().alpha = 0.5;
+    chain.Get<RateLimit<double>>().max_rate = 0.1;
+
+    WithStats stats;
+    stats.Init(0.3, 0.001, 3.5);
+
+    std::vector<Gains> rows;
+    for (int k = 0; k <= 20; k++) rows.push_back({0.3 - 0.01 * k, 0.001, 3.5 - 0.1 * k});
+    GainSchedule schedule(0, 5, rows);
+
+    Plain scheduled;
+    scheduled.Init(0.3, 0.001, 3.5);
+
+    int rounds = 2000;
+    std::cout << "PIDT<PID> (saturation only): " << nsPerUpdate(plain, trace, rounds) << " ns/update" << std::endl;
+    std::cout << "low-pass + anti-windup + rate limit + saturation: " << nsPerUpdate(chain, trace, rounds)
+              << " ns/update" << std::endl;
+    std::cout << "PIDT<PID> with error statistics: " << nsPerUpdate(stats, trace, rounds) << " ns/update"
+              << std::endl;
+    std::cout << "PIDT<PID> with speed-scheduled gains: " << nsPerScheduledUpdate(scheduled, schedule, trace, rounds)
+              << " ns/update" << std::endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "WorkPool.h"
+
+// Stands in for a headless episode of candidate k: up to 500 frames at a
+// fixed wall-clock cost each, cut short at a random frame when the car
+// leaves the track. Candidates come from an ordered grid and the first ones
+// are the weak gains, so those mostly end early while the rest drive the
+// whole episode. The result depends only on k and its seed.
+static const int kFrames = 500;
+static const uint64_t kSeed = 42;
+
+static double episode(size_t k, size_t tasks) {
+    std::mt19937_64 rng(WorkPool::Seed(kSeed, k));
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double stays = static_cast<double>(k) / tasks;
+    int frames = uniform(rng) < stays ? kFrames : static_cast<int>(uniform(rng) * kFrames / 10) + 1;
+    std::this_thread::sleep_for(std::chrono::microseconds(4 * frames));
+    double err = 0;
+    for (int i = 0; i < frames; i++) err += uniform(rng);
+    return err + (kFrames - frames);
+}
+
+// Each thread gets a fixed contiguous block up front.
+static void staticBlocks(size_t tasks, unsigned threads, std::vector<double> &out) {
+    auto block = [&](unsigned w) {
+        for (size_t k = tasks * w / threads; k < tasks * (w + 1) / threads; k++) out[k] = episode(k, tasks);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < threads; w++) pool.emplace_back(block, w);
+    block(0);
+    for (auto &t : pool) t.join();
+}
+
+int main() {
+    const size_t tasks = 256;
+    const unsigned threads = 4;
+    std::vector<double> serial(tasks), blocks(tasks), stealing(tasks);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < tasks; k++) serial[k] = episode(k, tasks);
+    auto t1 = std::chrono::steady_clock::now();
+    staticBlocks(tasks, threads, blocks);
+    auto t2 = std::chrono::steady_clock::now();
+    WorkPool pool(threads);
+    pool.Run(tasks, [&](size_t k) { stealing[k] = episode(k, tasks); });
+    auto t3 = std::chrono::steady_clock::now();
+
+    auto ms = [](std::chrono::steady_clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << tasks << " episodes of up to " << kFrames << " frames, " << threads << " workers" << std::endl;
+    std::cout << "serial:        " << ms(t1 - t0) << " ms" << std::endl;
+    std::cout << "static blocks: " << ms(t2 - t1) << " ms" << std::endl;
+    std::cout << "work stealing: " << ms(t3 - t2) << " ms, " << pool.Stolen() << " tasks stolen" << std::endl;
+    std::cout << "results " << (blocks == serial && stealing == serial ? "identical" : "DIFFER") << " across schedules"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "PIDT.h"
+#include "Fixed.h"
+#include "GainScreen.h"
+
+// the gains main() steers with, with a small Ki so the integral is exercised
+const double kKp = 0.3, kKi = 0.001, kKd = 3.5;
+
+// Steering for every step of the trace, converted back to double, and TotalError at the end.
+template<typename T>
+static std::vector<double> steerTrace(const std::vector<double> &trace, double &total_error) {
+    PIDT<Terms::PID, T> pid;
+    pid.Init(T(kKp), T(kKi), T(kKd));
+    std::vector<double> steer;
+    steer.reserve(trace.size());
+    for (double cte : trace) steer.push_back(static_cast<double>(pid.UpdateError(T(cte))));
+    total_error = pid.TotalError();
+    return steer;
+}
+
+// Updates per second over the trace, converted to T up front so only the update is timed.
+template<typename T>
+static double updatesPerSec(const std::vector<double> &trace, int rounds) {
+    std::vector<T> input(trace.begin(), trace.end());
+    PIDT<Terms::PID, T> pid;
+    pid.Init(T(kKp), T(kKi), T(kKd));
+    // summed in double, a sum over a long trace would overflow Q16.16
+    double sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        pid.Init(T(kKp), T(kKi), T(kKd));
+        for (const T &cte : input) sum += static_cast<double>(pid.UpdateError(cte));
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (sum == 42.4242) std::cout << "";
+    return double(rounds) * input.size() / std::chrono::duration<double>(end - start).count();
+}
+
+template<typename T>
+static void report(const char *name, const std::vector<double> &trace, const std::vector<double> &reference,
+                   double reference_error) {
+    double total_error;
+    std::vector<double> steer = steerTrace<T>(trace, total_error);
+    double max_dev = 0;
+    for (size_t k = 0; k < steer.size(); k++) max_dev = std::fmax(max_dev, std::fabs(steer[k] - reference[k]));
+    std::cout << name << ": " << updatesPerSec<T>(trace, 200) / 1e6 << " M updates/s, max deviation "
+              << max_dev << ", total error " << total_error << " (double: " << reference_error << ")" << std::endl;
+}
+
+// Usage: precision_bench [trace]. Without a trace a synthetic one is used, as
+// long as a recorded lap so the accumulated error gets past the Q16.16 range.
+int main(int argc, char *argv[]) {
+    std::vector<double> trace;
+    if (argc > 1) {
+        trace = loadTrace(argv[1]);
+    } else {
+        for (int i = 0; i < 20000; i++) trace.push_back(0.6 * std::sin(0.02 * i) + 0.05 * std::sin(0.11 * i));
+    }
+    if (trace.empty()) {
+        std::cerr << "empty trace" << std::endl;
+        return 1;
+    }
+
+    double reference_error;
+    std::vector<double> reference = steerTrace<double>(trace, reference_error);
+    std::cout << trace.size() << " steps" << std::endl;
+    report<double>("double", trace, reference, reference_error);
+    report<float>("float", trace, reference, reference_error);
+    report<Q16_16>("Q16.16", trace, reference, reference_error);
+#ifdef __SIZEOF_INT128__
+    report<Q32_32>("Q32.32", trace, reference, reference_error);
+#endif
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "GainScreen.h"
+
+// Usage: screen_bench [trace]. Without a trace a synthetic lap-like one is used.
+int main(int argc, char *argv[]) {
+    std::vector<double> trace;
+    if (argc > 1) {
+        trace = loadTrace(argv[1]);
+    } else {
+        for (int i = 0; i < 2000; i++) trace.push_back(0.6 * std::sin(0.02 * i) + 0.05 * std::sin(0.11 * i));
+    }
+    if (trace.empty()) {
+        std::cerr << "empty trace" << std::endl;
+        return 1;
+    }
+
+    // 64 x 64 grid over Kp and Kd, Ki held at 0 as in main()
+    std::vector<Gains> gains;
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) gains.push_back({0.02 * a, 0.0, 0.1 * b});
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto results = screenGains(trace, gains);
+    auto end = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count();
+
+    std::cout << gains.size() << " gain sets x " << trace.size() << " steps in " << us << " us ("
+              << gains.size() * trace.size() / us << " updates/us)" << std::endl;
+
+    // prune what saturates or weaves on a trace a good controller produced
+    size_t survivors = 0;
+    for (auto &r : results) {
+        if (r.saturated <= 0.05 && r.steer_rate <= 0.05) survivors++;
+    }
+    std::cout << gains.size() - survivors << " pruned, " << survivors << " left for closed-loop evaluation"
+              << std::endl;
+
+    auto reference = screenGains(trace, {{0.3, 0.0, 3.5}})[0];
+    std::cout << "main() gains: steer rate " << reference.steer_rate << ", saturated " << reference.saturated
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include <chrono>
+#include <iostream>
+#include "PID.h"
+#include "Simulator.h"
+
+// Usage: sim_bench [track]. Laps of the headless simulator with main()'s gains.
+int main(int argc, char *argv[]) {
+    Track track = argc > 1 ? Track::Load(argv[1]) : Track::Loop();
+    if (track.Size() == 0) {
+        std::cerr << "can't read track" << std::endl;
+        return 1;
+    }
+
+    SimConfig config;
+    Simulator sim(track, config);
+    PID pid;
+    SpeedControl speed;
+
+    int frames = 20000, runs = 50;
+    EpisodeResult r{};
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < runs; k++) {
+        sim.Reset();
+        pid.Init(0.3, 0, 3.5);
+        speed.Reset();
+        r = runEpisode(sim, pid, speed, frames);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double s = std::chrono::duration<double>(end - start).count();
+
+    double simulated = double(runs) * r.frames;
+    std::cout << simulated / s / 1e6 << " M frames/s, " << simulated * config.dt / s << "x real time" << std::endl;
+    std::cout << r.frames << " frames" << (r.off_track ? " (off track)" : "") << ", error: " << r.total_error
+              << ", mean speed: " << r.mean_speed << " mph, " << r.distance / track.length << " laps" << std::endl;
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "json.hpp"
+#include "Telemetry.h"
+#include "frames.h"
+
+using json = nlohmann::json;
+
+// The parse main.cpp did before decodeTelemetry: full DOM, string copies, std::stod.
+static Telemetry parseDom(std::string_view s) {
+    auto j = json::parse(s.begin(), s.end());
+    Telemetry t;
+    t.cte = std::stod(j[1]["cte"].get<std::string>());
+    t.speed = std::stod(j[1]["speed"].get<std::string>());
+    t.steering_angle = std::stod(j[1]["steering_angle"].get<std::string>());
+    return t;
+}
+
+static Telemetry parseFixed(std::string_view s) {
+    Telemetry t;
+    decodeTelemetry(s, t);
+    return t;
+}
+
+template<typename F>
+static double nsPerFrame(const std::vector<std::string_view> &frames, int rounds, F parse) {
+    double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (auto f : frames) sink += parse(f).cte;
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (sink == 42.4242) std::cout << "";
+    return std::chrono::duration<double, std::nano>(end - start).count() / (rounds * frames.size());
+}
+
+int main() {
+    auto recorded = recordedFrames();
+    std::vector<std::string_view> frames;
+    for (auto &f : recorded) {
+        std::string_view v = f;
+        frames.push_back(v.substr(v.find('[')));
+    }
+
+    int rounds = 100000;
+    double dom = nsPerFrame(frames, rounds, parseDom);
+    double fixed = nsPerFrame(frames, rounds, parseFixed);
+
+    std::cout << "json.hpp DOM:      " << dom << " ns/frame" << std::endl;
+    std::cout << "decodeTelemetry:   " << fixed << " ns/frame" << std::endl;
+    std::cout << "speedup:           " << dom / fixed << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "Tuner.h"
+
+// Stands in for an episode: a smooth bowl with ripples around Kp = 0.2, Kd = 3,
+// and a fixed wall-clock cost per evaluation like a simulator run has.
+static double episode(const std::vector<double> &p) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    double a = p[0] - 0.2, b = p[2] - 3.0;
+    return 1 + 4 * a * a + 0.1 * b * b + 0.01 * std::sin(20 * a) * std::sin(3 * b);
+}
+
+int main() {
+    std::vector<double> start = {1.5, 0, 0.5}, steps = {1, 0, 1};
+    double tolerance = 0.2 * 0.01;
+
+    auto t0 = std::chrono::steady_clock::now();
+    Tuner tuner(start, steps, tolerance);
+    int evaluations = 0;
+    tuner.Run([&evaluations](const std::vector<double> &p) { evaluations++; return episode(p); }, 100000);
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << "twiddle: " << evaluations << " evaluations, cost " << tuner.BestCost() << " in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+
+    ParallelTuner parallel(start, steps, tolerance);
+    t0 = std::chrono::steady_clock::now();
+    // one evaluator per probe, as with that many simulators
+    parallel.Run(episode, 100000, 5);
+    t1 = std::chrono::steady_clock::now();
+    std::cout << "parallel twiddle: " << parallel.Iteration() << " rounds, cost " << parallel.BestCost() << " in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+    std::cout << "best Kp = " << parallel.Best()[0] << ", Kd = " << parallel.Best()[2] << " (twiddle: Kp = "
+              << tuner.Best()[0] << ", Kd = " << tuner.Best()[2] << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include "BatchSimulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Taylor series, good to ~1e-7 for the angles a frame can turn (|a| < 0.5)
+// and, for tan, the steering range (|a| < 25 degrees)
+inline double polySin(double a) {
+    double a2 = a * a;
+    return a * (1 - a2 / 6 * (1 - a2 / 20 * (1 - a2 / 42 * (1 - a2 / 72))));
+}
+
+inline double polyCos(double a) {
+    double a2 = a * a;
+    return 1 - a2 / 2 * (1 - a2 / 12 * (1 - a2 / 30 * (1 - a2 / 56 * (1 - a2 / 90))));
+}
+
+inline double polyTan(double a) {
+    double a2 = a * a;
+    return a * (1 + a2 * (1.0 / 3 + a2 * (2.0 / 15 + a2 * (17.0 / 315 + a2 * (62.0 / 2835 + a2 * 1382.0 / 155925)))));
+}
+
+// The bicycle model of Simulator::Step for every car; cars off the track stand still.
+// Every array is a separate vector, __restrict saves the compiler the overlap
+// checks, and selects rather than std::clamp or fmin/fmax let the loop vectorize.
+void kinematics(const SimConfig &config, size_t cars, const double *__restrict steer,
+                const double *__restrict throttle, const double *__restrict moving, double *__restrict x,
+                double *__restrict y, double *__restrict hx, double *__restrict hy, double *__restrict v,
+                double *__restrict steering) {
+    const double dt = config.dt;
+    const double steer_rad = config.max_steer * kPi / 180;
+    const double turn = dt / config.wheelbase;
+    const double max_accel = config.max_accel, max_brake = config.max_brake, drag = config.drag;
+
+    for (size_t k = 0; k < cars; k++) {
+        double s = steer[k] < -1 ? -1 : steer[k] > 1 ? 1 : steer[k];
+        double thr = throttle[k] < -1 ? -1 : throttle[k] > 1 ? 1 : throttle[k];
+        steering[k] = s;
+
+        double ds = v[k] * dt * moving[k];
+        x[k] += ds * hx[k];
+        y[k] += ds * hy[k];
+
+        // positive steering turns clockwise
+        double a = -v[k] * turn * polyTan(s * steer_rad) * moving[k];
+        double c = polyCos(a), sn = polySin(a);
+        double nx = hx[k] * c - hy[k] * sn;
+        double ny = hx[k] * sn + hy[k] * c;
+        // one Newton step back to unit length
+        double fix = 1.5 - 0.5 * (nx * nx + ny * ny);
+        hx[k] = nx * fix;
+        hy[k] = ny * fix;
+
+        double accel = thr > 0 ? thr * max_accel : thr * max_brake;
+        double nv = v[k] + (accel - drag * v[k] * v[k]) * dt;
+        v[k] = (nv > 0 ? nv : 0) * moving[k];
+    }
+}
+
+const int kFollowSteps = 8; // segments a car can be followed per frame without Track::Locate
+
+// The common case of Track::Locate: walk each car's segment forward or back
+// while its projection falls beyond the segment, which usually stops after
+// a step or none, instead of comparing distances around it. At a corner the
+// walk can swing between two segments, which meet at the closest point either
+// way. A car still walking the same way after kFollowSteps moved further than
+// that and gets outran[k] = 1.
+void follow(const Track &track, size_t cars, const double *__restrict x, const double *__restrict y,
+            int64_t *__restrict segment, double *__restrict outran) {
+    const double *tx = track.x.data(), *ty = track.y.data();
+    const double *tdx = track.dx.data(), *tdy = track.dy.data(), *inv = track.inv_len2.data();
+    const int64_t last = static_cast<int64_t>(track.Size()) - 1;
+
+    for (size_t k = 0; k < cars; k++) {
+        int64_t s = segment[k];
+        int dir = 0, prev_dir = 0;
+        for (int step = 0; step <= kFollowSteps; step++) {
+            double u = ((x[k] - tx[s]) * tdx[s] + (y[k] - ty[s]) * tdy[s]) * inv[s];
+            int step_dir = u > 1 ? 1 : u < 0 ? -1 : 0;
+            // on the segment, or swinging across a corner
+            if (step_dir == 0 || step_dir == -dir || step == kFollowSteps) {
+                prev_dir = dir;
+                dir = step_dir;
+                break;
+            }
+            prev_dir = dir;
+            dir = step_dir;
+            s += dir;
+            s = s > last ? 0 : s < 0 ? last : s;
+        }
+        segment[k] = s;
+        outran[k] = dir != 0 && dir == prev_dir ? 1 : 0;
+    }
+}
+
+}
+
+BatchSimulator::BatchSimulator(const Track &track, SimConfig config, size_t cars)
+        : x(cars), y(cars), hx(cars), hy(cars), speed(cars), steering(cars), cte(cars), distance(cars),
+          off_track(cars), track(&track), config(config), segment(cars), along(cars), moving(cars),
+          outran(cars), rng(config.seed), noise(0.0, 1.0) {
+    Reset();
+}
+
+void BatchSimulator::Reset() {
+    double heading = track->Heading(0);
+    Track::Position start = track->Locate(track->x[0], track->y[0], 0);
+    std::fill(x.begin(), x.end(), track->x[0]);
+    std::fill(y.begin(), y.end(), track->y[0]);
+    std::fill(hx.begin(), hx.end(), std::cos(heading));
+    std::fill(hy.begin(), hy.end(), std::sin(heading));
+    std::fill(speed.begin(), speed.end(), 0.0);
+    std::fill(steering.begin(), steering.end(), 0.0);
+    std::fill(cte.begin(), cte.end(), start.cte);
+    std::fill(distance.begin(), distance.end(), 0.0);
+    std::fill(off_track.begin(), off_track.end(), 0);
+    std::fill(moving.begin(), moving.end(), 1.0);
+    std::fill(segment.begin(), segment.end(), static_cast<int64_t>(start.segment));
+    std::fill(along.begin(), along.end(), start.s);
+
+    slots = static_cast<size_t>(std::max(config.delay, 0)) + 1;
+    pending_steer.assign(slots * Size(), 0.0);
+    pending_throttle.assign(slots * Size(), 0.0);
+    at = 0;
+    rng.seed(config.seed);
+}
+
+void BatchSimulator::Observe(double *reported) {
+    size_t cars = Size();
+    std::copy(cte.begin(), cte.end(), reported);
+    if (config.cte_noise > 0) {
+        for (size_t k = 0; k < cars; k++) reported[k] += config.cte_noise * noise(rng);
+    }
+}
+
+void BatchSimulator::Step(const double *steer, const double *throttle) {
+    size_t cars = Size();
+    std::copy(steer, steer + cars, pending_steer.begin() + at * cars);
+    std::copy(throttle, throttle + cars, pending_throttle.begin() + at * cars);
+    at = (at + 1) % slots;
+    const double *applied_steer = pending_steer.data() + at * cars;
+    const double *applied_throttle = pending_throttle.data() + at * cars;
+
+    kinematics(config, cars, applied_steer, applied_throttle, moving.data(), x.data(), y.data(), hx.data(),
+               hy.data(), speed.data(), steering.data());
+
+    follow(*track, cars, x.data(), y.data(), segment.data(), outran.data());
+
+    for (size_t k = 0; k < cars; k++) {
+        if (off_track[k]) continue;
+        size_t sg = static_cast<size_t>(segment[k]);
+        // follow settled on the closest segment unless it outran the walk
+        Track::Position p = outran[k] != 0 ? track->Locate(x[k], y[k], sg) : track->Project(sg, x[k], y[k]);
+        segment[k] = static_cast<int64_t>(p.segment);
+        double ds = p.s - along[k];
+        // across the start line
+        if (ds < -track->length / 2) ds += track->length;
+        if (ds > track->length / 2) ds -= track->length;
+        distance[k] += ds;
+        along[k] = p.s;
+        cte[k] = p.cte;
+        off_track[k] = std::fabs(p.cte) > track->half_width;
+        moving[k] = off_track[k] ? 0 : 1;
+    }
+}
+
+std::vector<EpisodeResult> runBatchEpisode(BatchSimulator &sim, PIDBank &bank, const SpeedControl &speed,
+                                           int frames) {
+    size_t cars = sim.Size();
+    std::vector<double> reported(cars), steer(cars), throttle(cars, 0.0);
+    std::vector<double> err(cars, 0.0);
+    std::vector<int> driven(cars, 0);
+    std::vector<SpeedControl> speeds(cars, speed);
+    for (auto &s : speeds) s.Reset();
+
+    for (int i = 0; i < frames; i++) {
+        sim.Observe(reported.data());
+        bank.UpdateError(reported.data(), steer.data());
+
+        // a car off the track stands still, its speed controller is left where it stopped
+        for (size_t k = 0; k < cars; k++) {
+            if (sim.off_track[k]) continue;
+            throttle[k] = speeds[k].Update(sim.speed[k] * kMph, reported[k], steer[k]);
+            err[k] += (1 + std::fabs(reported[k])) * (1 + std::fabs(reported[k]));
+            driven[k]++;
+        }
+        sim.Step(steer.data(), throttle.data());
+    }
+
+    std::vector<EpisodeResult> results(cars);
+    double off = 1 + sim.HalfWidth();
+    for (size_t k = 0; k < cars; k++) {
+        double total = err[k] + (frames - driven[k]) * off * off;
+        results[k] = {driven[k], frames ? total / frames : 0, speeds[k].MeanSpeed(), sim.distance[k],
+                      sim.off_track[k] != 0};
+    }
+    return results;
+}
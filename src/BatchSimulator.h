@@ -0,0 +1,74 @@
+#ifndef BATCH_SIMULATOR_H
+#define BATCH_SIMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "PIDBank.h"
+#include "Simulator.h"
+
+/*
+* M independent cars on one Track, stepped in lockstep; the model of
+* Simulator. State is kept as structure-of-arrays, one entry per car, and
+* the heading is a unit vector turned by a polynomial rotation so the
+* kinematics loop is plain multiply-adds the compiler vectorizes. Finding
+* each car on the track is a scalar O(1) walk per car. A car that leaves
+* the track stops and keeps its last figures.
+*/
+class BatchSimulator {
+public:
+    std::vector<double> x, y;     // m
+    std::vector<double> hx, hy;   // heading, unit vector
+    std::vector<double> speed;    // m/s
+    std::vector<double> steering; // applied, [-1, 1]
+    std::vector<double> cte;      // m, true offset from the centreline
+    std::vector<double> distance; // m along the centreline since Reset
+    std::vector<char> off_track;
+
+    BatchSimulator(const Track &track, SimConfig config, size_t cars);
+
+    size_t Size() const { return x.size(); }
+
+    void Reset();
+
+    /*
+    * Queue a command for every car and advance one frame with the commands
+    * from delay frames ago.
+    */
+    void Step(const double *steer, const double *throttle);
+
+    /*
+    * cte as reported to the controllers, with the configured noise.
+    */
+    void Observe(double *reported);
+
+    const SimConfig &Config() const { return config; }
+
+    double HalfWidth() const { return track->half_width; }
+
+private:
+    const Track *track;
+    SimConfig config;
+    std::vector<int64_t> segment;
+    std::vector<double> along; // distance along the loop of the closest point
+    std::vector<double> moving; // 0 for cars off the track, 1 otherwise, for the kinematics loop
+    std::vector<double> outran; // where follow gave up on a car, see BatchSimulator.cpp
+
+    std::vector<double> pending_steer, pending_throttle; // slots of Size() commands
+    size_t slots; // delay + 1
+    size_t at;
+
+    std::mt19937_64 rng;
+    std::normal_distribution<double> noise;
+};
+
+/*
+* runEpisode for every car at once: bank lane k steers car k, and a copy
+* of speed, reset, sets its throttle through the same SpeedControl::Update
+* the scalar path calls. Lanes and cars must match in number.
+*/
+std::vector<EpisodeResult> runBatchEpisode(BatchSimulator &sim, PIDBank &bank, const SpeedControl &speed,
+                                           int frames);
+
+#endif /* BATCH_SIMULATOR_H */
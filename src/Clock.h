@@ -0,0 +1,95 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+/*
+* Monotonic time in nanoseconds. CLOCK_MONOTONIC is served from the vDSO on
+* Linux, so this does not enter the kernel.
+*/
+inline uint64_t monotonicNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+* Time stamp counter scaled to nanoseconds on the monotonicNanos() time base.
+* The scale is measured once, over about 10 ms, against CLOCK_MONOTONIC.
+* Only usable when the CPU has an invariant TSC, check Available() first.
+*/
+class TscClock {
+public:
+    static const TscClock &Instance() {
+        static TscClock clock;
+        return clock;
+    }
+
+    bool Available() const { return available; }
+
+    uint64_t Nanos() const {
+#if defined(__x86_64__) || defined(__i386__)
+        return base_ns + static_cast<uint64_t>(static_cast<double>(__rdtsc() - base_tsc) * ns_per_tick);
+#else
+        return monotonicNanos();
+#endif
+    }
+
+private:
+    TscClock() {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned a, b, c, d;
+        available = __get_cpuid(0x80000007, &a, &b, &c, &d) && (d & (1u << 8)); // invariant TSC
+        if (!available) return;
+
+        base_ns = monotonicNanos();
+        base_tsc = __rdtsc();
+        uint64_t end_ns;
+        do {
+            end_ns = monotonicNanos();
+        } while (end_ns - base_ns < 10000000);
+        ns_per_tick = static_cast<double>(end_ns - base_ns) / static_cast<double>(__rdtsc() - base_tsc);
+#endif
+    }
+
+    bool available = false;
+    uint64_t base_ns = 0;
+    uint64_t base_tsc = 0;
+    double ns_per_tick = 0;
+};
+
+/*
+* Spacing of controlled frames in nominal frame periods, the nominal period
+* being a running mean of the spacing. Steps are clamped to [0.25, 4] so a
+* pause or reset does not throw the derivative off.
+*/
+class FrameTimer {
+public:
+    /*
+    * The step since the previous call, 1 on the first call.
+    */
+    double Step(uint64_t now) {
+        if (last == 0) {
+            last = now;
+            return 1;
+        }
+        double interval = static_cast<double>(now - last);
+        last = now;
+        period = period == 0 ? interval : 0.95 * period + 0.05 * interval;
+        if (period <= 0) return 1;
+        double dt = interval / period;
+        return dt < 0.25 ? 0.25 : dt > 4 ? 4 : dt;
+    }
+
+private:
+    uint64_t last = 0;
+    double period = 0; // ns
+};
+
+#endif /* CLOCK_H */
@@ -0,0 +1,36 @@
+#ifndef DRIVE_H
+#define DRIVE_H
+
+#include "GainSchedule.h"
+#include "SpeedControl.h"
+
+/*
+* Steering and throttle for one frame.
+*/
+struct Actuation {
+    double steering_angle;
+    double throttle;
+};
+
+/*
+* The controller step for one telemetry frame. The socket handler and the
+* headless simulator both call it, so they drive the car the same way.
+* With a schedule the steering gains follow the reported speed (mph) and
+* the error state carries over. dt is the spacing to the previous frame in
+* nominal periods, 0 for a fixed step. Throttle comes from speed, which
+* sees this frame's steering.
+*/
+template<typename Steering>
+Actuation drive(Steering &pid, SpeedControl &speed, const GainSchedule *schedule, double cte, double mph,
+                double dt) {
+    if (schedule) {
+        Gains g = schedule->At(mph);
+        pid.Kp = g.Kp;
+        pid.Ki = g.Ki;
+        pid.Kd = g.Kd;
+    }
+    double steer = dt > 0 ? pid.UpdateError(cte, dt) : pid.UpdateError(cte);
+    return {steer, speed.Update(mph, cte, steer, dt)};
+}
+
+#endif /* DRIVE_H */
@@ -0,0 +1,124 @@
+#include "ErrorStats.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void P2Quantile::Reset() {
+    count = 0;
+    for (int i = 0; i < 5; i++) {
+        q[i] = 0;
+        pos[i] = i;
+    }
+    want[0] = 0;
+    want[1] = 2 * p;
+    want[2] = 4 * p;
+    want[3] = 2 + 2 * p;
+    want[4] = 4;
+}
+
+void P2Quantile::Add(double x) {
+    if (count < 5) {
+        q[count++] = x;
+        if (count == 5) std::sort(q, q + 5);
+        return;
+    }
+    count++;
+
+    // cell the value falls in, stretching the end markers if needed
+    int k;
+    if (x < q[0]) {
+        q[0] = x;
+        k = 0;
+    } else if (x >= q[4]) {
+        q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (x >= q[k + 1]) k++;
+    }
+    for (int i = k + 1; i < 5; i++) pos[i]++;
+    want[1] += p / 2;
+    want[2] += p;
+    want[3] += (1 + p) / 2;
+    want[4] += 1;
+
+    // move the middle markers that drifted a position or more from where they should be
+    for (int i = 1; i < 4; i++) {
+        double d = want[i] - pos[i];
+        if ((d >= 1 && pos[i + 1] - pos[i] > 1) || (d <= -1 && pos[i - 1] - pos[i] < -1)) {
+            double s = d > 0 ? 1 : -1;
+            double parabolic = q[i] + s / (pos[i + 1] - pos[i - 1]) *
+                                      ((pos[i] - pos[i - 1] + s) * (q[i + 1] - q[i]) / (pos[i + 1] - pos[i]) +
+                                       (pos[i + 1] - pos[i] - s) * (q[i] - q[i - 1]) / (pos[i] - pos[i - 1]));
+            if (q[i - 1] < parabolic && parabolic < q[i + 1]) {
+                q[i] = parabolic;
+            } else {
+                int j = i + static_cast<int>(s);
+                q[i] += s * (q[j] - q[i]) / (pos[j] - pos[i]);
+            }
+            pos[i] += s;
+        }
+    }
+}
+
+double P2Quantile::Value() const {
+    if (count == 0) return 0;
+    if (count < 5) {
+        double sorted[5];
+        std::copy(q, q + count, sorted);
+        std::sort(sorted, sorted + count);
+        return sorted[static_cast<size_t>(std::lround(p * (count - 1)))];
+    }
+    return q[2];
+}
+
+void ErrorStats::Reset() {
+    count = 0;
+    mean = m2 = 0;
+    min = std::numeric_limits<double>::infinity();
+    max = -std::numeric_limits<double>::infinity();
+    ewma = 0;
+    std::fill(window, window + kWindow, 0.0);
+    window_sum = 0;
+    window_at = 0;
+    p50.Reset();
+    p95.Reset();
+    p99.Reset();
+}
+
+void ErrorStats::Add(double cte) {
+    count++;
+    double delta = cte - mean;
+    mean += delta / count;
+    m2 += delta * (cte - mean);
+    min = std::min(min, cte);
+    max = std::max(max, cte);
+
+    double level = std::fabs(cte);
+    ewma = count == 1 ? level : ewma + alpha * (level - ewma);
+
+    window_sum += level - window[window_at];
+    window[window_at] = level;
+    if (++window_at == kWindow) {
+        // re-add once per lap of the ring so rounding in the running sum can't build up
+        window_at = 0;
+        window_sum = 0;
+        for (double w : window) window_sum += w;
+    }
+
+    p50.Add(level);
+    p95.Add(level);
+    p99.Add(level);
+}
+
+double ErrorStats::WindowMean() const {
+    uint64_t frames = std::min<uint64_t>(count, kWindow);
+    return frames ? window_sum / frames : 0;
+}
+
+std::ostream &operator<<(std::ostream &os, const ErrorStats &stats) {
+    return os << "cte frames: " << stats.Count() << ", mean: " << stats.Mean()
+              << ", sd: " << std::sqrt(stats.Variance()) << ", min: " << stats.Min() << ", max: " << stats.Max()
+              << ", |cte| ewma: " << stats.Ewma() << ", last " << ErrorStats::kWindow << ": " << stats.WindowMean()
+              << ", p50: " << stats.p50.Value() << ", p95: " << stats.p95.Value() << ", p99: " << stats.p99.Value();
+}
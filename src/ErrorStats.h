@@ -0,0 +1,104 @@
+#ifndef ERROR_STATS_H
+#define ERROR_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include "Pipeline.h"
+
+/*
+* Streaming estimate of one quantile with the P² algorithm (Jain and
+* Chlamtac): five markers whose heights follow the quantile, adjusted by
+* piecewise-parabolic interpolation. O(1) time and memory per value.
+*/
+class P2Quantile {
+public:
+    explicit P2Quantile(double p = 0.5) : p(p) { Reset(); }
+
+    void Reset();
+
+    void Add(double x);
+
+    /*
+    * The estimate, exact while fewer than five values were added, 0 before the first.
+    */
+    double Value() const;
+
+private:
+    double p;
+    uint64_t count;
+    double q[5];  // marker heights
+    double pos[5]; // marker positions
+    double want[5]; // desired positions
+};
+
+/*
+* Summary of the cross track error over a session, updated in constant time
+* and memory per frame so long runs can be summarized without a log:
+* mean and variance of cte (Welford), its extremes, and the level of |cte|
+* as an exponentially weighted mean, a mean over the last kWindow frames,
+* and its p50/p95/p99.
+*/
+class ErrorStats {
+public:
+    static constexpr size_t kWindow = 256;
+
+    double alpha = 0.05; // weight of the newest frame in the EWMA
+
+    ErrorStats() : p50(0.5), p95(0.95), p99(0.99) { Reset(); }
+
+    void Reset();
+
+    void Add(double cte);
+
+    uint64_t Count() const { return count; }
+
+    double Mean() const { return mean; }
+
+    /*
+    * Sample variance, 0 below two frames.
+    */
+    double Variance() const { return count > 1 ? m2 / (count - 1) : 0; }
+
+    double Min() const { return min; }
+
+    double Max() const { return max; }
+
+    double Ewma() const { return ewma; }
+
+    /*
+    * Mean |cte| over the last kWindow frames, or all of them if fewer.
+    */
+    double WindowMean() const;
+
+    P2Quantile p50, p95, p99; // of |cte|
+
+private:
+    uint64_t count;
+    double mean, m2;
+    double min, max;
+    double ewma;
+
+    double window[kWindow];
+    double window_sum;
+    size_t window_at;
+};
+
+/*
+* One line summary of the statistics.
+*/
+std::ostream &operator<<(std::ostream &os, const ErrorStats &stats);
+
+/*
+* Controller stage feeding every cte to an ErrorStats, reset with the controller.
+*/
+template<typename T>
+struct ErrorStatistics : Stage<T> {
+    ErrorStats stats;
+
+    void Reset() { stats.Reset(); }
+
+    void Error(T cte) { stats.Add(static_cast<double>(cte)); }
+};
+
+#endif /* ERROR_STATS_H */
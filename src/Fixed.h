@@ -0,0 +1,71 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+/*
+* Signed binary fixed point with Frac fractional bits stored in Rep; Wide
+* holds a full product. It has the arithmetic Controller needs, so it can be
+* its T: Q16_16 and Q32_32 below.
+*
+* Multiplication and division truncate towards minus infinity, overflow is
+* not checked. Q16.16 ends at +-32768. Controller keeps err in double for
+* this reason; int_cte only stays in range while the integral does, and
+* the steering value itself is bounded by the output clamp.
+*/
+template<int Frac, typename Rep, typename Wide>
+class Fixed {
+public:
+    static constexpr Rep kOne = Rep(1) << Frac;
+
+    Rep raw = 0;
+
+    constexpr Fixed() = default;
+
+    /*
+    * From any arithmetic value, floating point is rounded to nearest.
+    */
+    template<typename N, typename = std::enable_if_t<std::is_arithmetic_v<N>>>
+    constexpr Fixed(N v) {
+        if constexpr (std::is_integral_v<N>) raw = static_cast<Rep>(static_cast<Rep>(v) * kOne);
+        else raw = static_cast<Rep>(std::llround(static_cast<double>(v) * kOne));
+    }
+
+    static constexpr Fixed FromRaw(Rep r) {
+        Fixed f;
+        f.raw = r;
+        return f;
+    }
+
+    explicit constexpr operator double() const { return static_cast<double>(raw) / kOne; }
+
+    // hidden friends, so 1 + x and err / n convert the int side
+    friend constexpr Fixed operator+(Fixed a, Fixed b) { return FromRaw(a.raw + b.raw); }
+    friend constexpr Fixed operator-(Fixed a, Fixed b) { return FromRaw(a.raw - b.raw); }
+    friend constexpr Fixed operator-(Fixed a) { return FromRaw(-a.raw); }
+    friend constexpr Fixed operator*(Fixed a, Fixed b) {
+        return FromRaw(static_cast<Rep>((static_cast<Wide>(a.raw) * b.raw) >> Frac));
+    }
+    friend constexpr Fixed operator/(Fixed a, Fixed b) {
+        return FromRaw(static_cast<Rep>(static_cast<Wide>(a.raw) * kOne / b.raw));
+    }
+
+    constexpr Fixed &operator+=(Fixed b) { return *this = *this + b; }
+
+    friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+    friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+    friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+
+    // found by ADL next to std::fabs in Controller
+    friend constexpr Fixed fabs(Fixed a) { return a.raw < 0 ? -a : a; }
+};
+
+using Q16_16 = Fixed<16, int32_t, int64_t>;
+
+#ifdef __SIZEOF_INT128__
+using Q32_32 = Fixed<32, int64_t, __int128>;
+#endif
+
+#endif /* FIXED_H */
@@ -0,0 +1,62 @@
+#include "FrameScanner.h"
+#include "JsonText.h"
+#include "Simd.h"
+
+namespace {
+
+size_t findFirst(std::string_view s, char c) {
+    const char *p = s.data();
+    size_t i = 0;
+    for (; i + kSimdWidth <= s.size(); i += kSimdWidth) {
+        uint64_t m = matchMask(p + i, c);
+        if (m) return i + lowestBit(m);
+    }
+    for (; i < s.size(); i++) {
+        if (p[i] == c) return i;
+    }
+    return std::string_view::npos;
+}
+
+// Scans backward, but never below from.
+size_t findLast(std::string_view s, char c, size_t from) {
+    const char *p = s.data();
+    size_t end = s.size();
+    for (; end >= from + kSimdWidth; end -= kSimdWidth) {
+        uint64_t m = matchMask(p + end - kSimdWidth, c);
+        if (m) return end - kSimdWidth + highestBit(m);
+    }
+    while (end > from) {
+        if (p[--end] == c) return end;
+    }
+    return std::string_view::npos;
+}
+
+}
+
+FrameScan scanFrame(std::string_view frame) {
+    FrameScan scan{FrameKind::Invalid, {}};
+
+    size_t b1 = findFirst(frame, '[');
+    if (b1 == std::string_view::npos) return scan;
+    size_t b2 = findLast(frame, ']', b1 + 1);
+    if (b2 == std::string_view::npos) return scan;
+    scan.array = frame.substr(b1, b2 - b1 + 1);
+
+    // ["event"  ,  payload ... ]
+    std::string_view a = scan.array;
+    size_t i = skipSpace(a, 1);
+    if (i >= a.size() || a[i] != '"') return scan;
+    for (i++; i < a.size() && a[i] != '"'; i++) {
+        if (a[i] == '\\') i++;
+    }
+    if (i >= a.size()) return scan;
+    i = skipSpace(a, i + 1);
+
+    if (a[i] == ']') {
+        scan.kind = FrameKind::Manual;
+    } else if (a[i] == ',') {
+        i = skipSpace(a, i + 1);
+        scan.kind = a.compare(i, 4, "null") == 0 ? FrameKind::Manual : FrameKind::Data;
+    }
+    return scan;
+}
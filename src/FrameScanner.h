@@ -0,0 +1,26 @@
+#ifndef FRAME_SCANNER_H
+#define FRAME_SCANNER_H
+
+#include <string_view>
+
+enum class FrameKind {
+    Invalid, // no ["event",...] array in the frame
+    Manual,  // the event carries no data (null or missing), the sim is driven by hand
+    Data     // the event carries a payload
+};
+
+struct FrameScan {
+    FrameKind kind;
+    std::string_view array; // outer [...] of the socket.io event, a view into the frame
+};
+
+/*
+* Locate the outer brackets of a socket.io event frame and classify it.
+* The first '[' is found scanning forward and the last ']' scanning backward,
+* kSimdWidth bytes at a time, so each byte is looked at most once and a
+* normal frame only touches the blocks at either end. Only the value right
+* after the event name decides Manual, a "null" inside field values does not.
+*/
+FrameScan scanFrame(std::string_view frame);
+
+#endif /* FRAME_SCANNER_H */
@@ -0,0 +1,47 @@
+#include "FrameStats.h"
+
+FrameStamp FrameStats::Stamp(uint64_t now) {
+    return {next_seq++, now};
+}
+
+bool FrameStats::Admit(const FrameStamp &stamp, uint64_t now) {
+    if (deadline == 0 || now - stamp.arrival <= deadline) return true;
+    late++;
+    return !reject;
+}
+
+bool FrameStats::Sender(uint64_t seq) {
+    if (!have_sender) {
+        have_sender = true;
+        last_sender = seq;
+        return true;
+    }
+    if (seq == last_sender) {
+        duplicated++;
+        return !reject;
+    }
+    if (seq < last_sender) {
+        out_of_order++;
+        return !reject;
+    }
+    last_sender = seq;
+    return true;
+}
+
+void FrameStats::Replied(const FrameStamp &stamp, uint64_t now) {
+    uint64_t latency = now - stamp.arrival;
+    latency_sum += latency;
+    replies++;
+    if (latency > max_latency) max_latency = latency;
+}
+
+double FrameStats::MeanLatency() const {
+    return replies ? latency_sum / replies : 0;
+}
+
+std::ostream &operator<<(std::ostream &os, const FrameStats &stats) {
+    return os << "late: " << stats.late << ", duplicated: " << stats.duplicated
+              << ", out of order: " << stats.out_of_order
+              << ", latency us mean: " << stats.MeanLatency() / 1000
+              << ", max: " << stats.MaxLatency() / 1000.0;
+}
@@ -0,0 +1,73 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <cstdint>
+#include <ostream>
+
+/*
+* Stamp given to a frame when uWS hands it to us.
+*/
+struct FrameStamp {
+    uint64_t seq;     // arrival order on the connection
+    uint64_t arrival; // monotonicNanos() at arrival
+};
+
+/*
+* Per-connection frame order and age bookkeeping.
+*
+* A frame is late when more than deadline passed between its arrival and
+* the moment the controller would act on it (coalescing and slow handling
+* both show up here). Duplicates and reordering can only be told from the
+* sender's own sequence number, which the binary protocol carries.
+* With reject set, late, duplicated and out-of-order frames are counted and
+* skipped, otherwise they are only counted.
+*/
+class FrameStats {
+public:
+    uint64_t deadline = 0; // ns, 0 disables the check
+    bool reject = false;
+
+    unsigned long late = 0;
+    unsigned long duplicated = 0;
+    unsigned long out_of_order = 0;
+
+    /*
+    * Stamp a frame that just arrived.
+    */
+    FrameStamp Stamp(uint64_t now);
+
+    /*
+    * Account for a frame about to reach the controller, false if it should be skipped.
+    */
+    bool Admit(const FrameStamp &stamp, uint64_t now);
+
+    /*
+    * Check the sender's sequence number, false if the frame should be skipped.
+    */
+    bool Sender(uint64_t seq);
+
+    /*
+    * Time from arrival to the reply being handed to uWS.
+    */
+    void Replied(const FrameStamp &stamp, uint64_t now);
+
+    double MeanLatency() const;
+
+    uint64_t MaxLatency() const { return max_latency; }
+
+private:
+    uint64_t next_seq = 0;
+    bool have_sender = false;
+    uint64_t last_sender = 0;
+
+    double latency_sum = 0;
+    unsigned long replies = 0;
+    uint64_t max_latency = 0;
+};
+
+/*
+* One line summary: counters and arrival-to-reply latency in microseconds.
+*/
+std::ostream &operator<<(std::ostream &os, const FrameStats &stats);
+
+#endif /* FRAME_STATS_H */
@@ -0,0 +1,55 @@
+#include "GainSchedule.h"
+#include <fstream>
+#include <sstream>
+
+GainSchedule::GainSchedule(double speed0, double step, const std::vector<Gains> &rows)
+        : speed0(speed0), step(step), inv_step(1 / step), last(rows.empty() ? 0 : rows.size() - 1.0),
+          table(rows.size()) {
+    for (size_t k = 0; k < rows.size(); k++) table[k].gains = rows[k];
+    for (size_t k = 0; k < rows.size(); k++) slopes(k);
+}
+
+void GainSchedule::SetRow(size_t k, const Gains &g) {
+    table[k].gains = g;
+    slopes(k);
+    if (k > 0) slopes(k - 1);
+}
+
+void GainSchedule::slopes(size_t k) {
+    if (k + 1 == table.size()) {
+        table[k].slope = {0, 0, 0};
+        return;
+    }
+    const Gains &a = table[k].gains, &b = table[k + 1].gains;
+    table[k].slope = {b.Kp - a.Kp, b.Ki - a.Ki, b.Kd - a.Kd};
+}
+
+bool GainSchedule::Load(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::stringstream numbers;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        numbers << line << '\n';
+    }
+
+    double first, spacing;
+    if (!(numbers >> first >> spacing) || !(spacing > 0)) return false;
+    std::vector<Gains> rows;
+    Gains g;
+    while (numbers >> g.Kp >> g.Ki >> g.Kd) rows.push_back(g);
+    if (rows.empty() || !numbers.eof()) return false;
+
+    *this = GainSchedule(first, spacing, rows);
+    return true;
+}
+
+bool GainSchedule::Save(const std::string &path) const {
+    std::ofstream out(path);
+    out.precision(17);
+    out << "# speed0 step\n" << speed0 << ' ' << step << "\n# Kp Ki Kd per row\n";
+    for (auto &r : table) out << r.gains.Kp << ' ' << r.gains.Ki << ' ' << r.gains.Kd << '\n';
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,76 @@
+#ifndef GAIN_SCHEDULE_H
+#define GAIN_SCHEDULE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Gains.h"
+
+/*
+* Gains as a function of speed, tabulated at speed0, speed0 + step, ...
+* At() interpolates linearly between the two neighbouring rows and holds
+* the first/last row outside the table. Each row is stored with its slope
+* to the next one and the step as its inverse, so the lookup is a
+* multiply, two selects, a truncation and three multiply-adds, inline.
+* The table is a few hundred bytes and stays in cache next to the
+* controller.
+*
+* File format (text): speed0 and step, then Kp Ki Kd for each row.
+* Lines starting with # are comments.
+*/
+class GainSchedule {
+public:
+    GainSchedule() = default;
+
+    GainSchedule(double speed0, double step, const std::vector<Gains> &rows);
+
+    bool Empty() const { return table.empty(); }
+
+    size_t Size() const { return table.size(); }
+
+    double Speed0() const { return speed0; }
+
+    double Step() const { return step; }
+
+    const Gains &Row(size_t k) const { return table[k].gains; }
+
+    void SetRow(size_t k, const Gains &g);
+
+    /*
+    * Not for an empty schedule.
+    */
+    Gains At(double speed) const {
+        double x = (speed - speed0) * inv_step;
+        // written as selects so they compile to maxsd/minsd; NaN lands on the first row
+        x = x > 0 ? x : 0;
+        x = x < last ? x : last;
+        // x >= 0, so truncation is floor
+        size_t base = static_cast<size_t>(x);
+        double t = x - static_cast<double>(base);
+        const Entry &r = table[base];
+        return {r.gains.Kp + t * r.slope.Kp, r.gains.Ki + t * r.slope.Ki, r.gains.Kd + t * r.slope.Kd};
+    }
+
+    /*
+    * Read a schedule, false if the file is missing or malformed.
+    */
+    bool Load(const std::string &path);
+
+    bool Save(const std::string &path) const;
+
+private:
+    struct Entry {
+        Gains gains;
+        Gains slope; // to the next row per unit of x, zero on the last row
+    };
+
+    void slopes(size_t k);
+
+    double speed0 = 0;
+    double step = 1;
+    double inv_step = 1;
+    double last = 0; // index of the last row
+    std::vector<Entry> table;
+};
+
+#endif /* GAIN_SCHEDULE_H */
@@ -0,0 +1,59 @@
+#include "GainScreen.h"
+#include "PIDBank.h"
+#include "WorkPool.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+const size_t kBatch = 256; // lanes per PIDBank, small enough to stay in L1/L2
+const double kMaxSteer = 0.6;
+
+void screenBatch(const std::vector<double> &trace, const Gains *gains, size_t count, ScreenResult *out) {
+    PIDBank bank(count);
+    for (size_t k = 0; k < count; k++) bank.Init(k, gains[k].Kp, gains[k].Ki, gains[k].Kd);
+
+    std::vector<double> cte(count), steer(count), prev_steer(count, 0.0), rate(count, 0.0), sat(count, 0.0);
+    for (size_t i = 0; i < trace.size(); i++) {
+        std::fill(cte.begin(), cte.end(), trace[i]);
+        bank.UpdateError(cte.data(), steer.data());
+        for (size_t k = 0; k < count; k++) {
+            rate[k] += std::fabs(steer[k] - prev_steer[k]);
+            sat[k] += std::fabs(steer[k]) >= kMaxSteer ? 1.0 : 0.0;
+            prev_steer[k] = steer[k];
+        }
+    }
+
+    double steps = trace.empty() ? 1 : trace.size();
+    for (size_t k = 0; k < count; k++) {
+        out[k].total_error = trace.empty() ? 0 : bank.TotalError(k);
+        out[k].steer_rate = rate[k] / steps;
+        out[k].saturated = sat[k] / steps;
+    }
+}
+
+}
+
+std::vector<ScreenResult> screenGains(const std::vector<double> &trace, const std::vector<Gains> &gains,
+                                      unsigned threads) {
+    std::vector<ScreenResult> results(gains.size());
+    size_t batches = (gains.size() + kBatch - 1) / kBatch;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    WorkPool pool(static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(batches, 1))));
+    pool.Run(batches, [&](size_t b) {
+        size_t first = b * kBatch;
+        size_t count = std::min(kBatch, gains.size() - first);
+        screenBatch(trace, gains.data() + first, count, results.data() + first);
+    });
+    return results;
+}
+
+std::vector<double> loadTrace(const std::string &path) {
+    std::vector<double> trace;
+    std::ifstream in(path);
+    double cte;
+    while (in >> cte) trace.push_back(cte);
+    return trace;
+}
@@ -0,0 +1,34 @@
+#ifndef GAIN_SCREEN_H
+#define GAIN_SCREEN_H
+
+#include <string>
+#include <vector>
+#include "Gains.h"
+
+/*
+* Open-loop figures of one gain set over a recorded trace.
+*/
+struct ScreenResult {
+    double total_error; // TotalError() after the trace, depends on the trace only when open loop
+    double steer_rate;  // mean |steer[i] - steer[i-1]|, high for gains that make the car weave
+    double saturated;   // fraction of steps the output sat on the +-0.6 clamp
+};
+
+/*
+* Replay one recorded cross track error trace through the UpdateError
+* recurrence of every gain set. Gain sets are packed into PIDBank lanes,
+* so each SIMD lane carries one candidate, and the batches are spread over
+* a WorkPool of threads (0: one per core). The car does not react to the
+* steering here, so this only screens out candidates that are clearly bad
+* (saturating or oscillating on a trace a good controller produced) before
+* they get closed-loop time.
+*/
+std::vector<ScreenResult> screenGains(const std::vector<double> &trace, const std::vector<Gains> &gains,
+                                      unsigned threads = 0);
+
+/*
+* Read a trace written by pid --record, one cross track error per line.
+*/
+std::vector<double> loadTrace(const std::string &path);
+
+#endif /* GAIN_SCREEN_H */
@@ -0,0 +1,13 @@
+#ifndef GAINS_H
+#define GAINS_H
+
+/*
+* One set of PID coefficients.
+*/
+struct Gains {
+    double Kp;
+    double Ki;
+    double Kd;
+};
+
+#endif /* GAINS_H */
@@ -0,0 +1,156 @@
+#include "JsonIndex.h"
+#include "JsonText.h"
+#include "Simd.h"
+#include <cstring>
+
+namespace {
+
+const char kOperators[] = "{}[]:,";
+const uint64_t kEvenBits = 0x5555555555555555ULL;
+
+}
+
+bool JsonIndex::Build(std::string_view s) {
+    json = s;
+    pos.clear();
+    match.clear();
+    if (s.size() >= UINT32_MAX) return false;
+
+    uint64_t prev_escaped = 0;  // the first byte of the next block is escaped
+    uint64_t prev_in_string = 0; // all ones when the previous block ended inside a string
+    char tail[64];
+
+    for (size_t base = 0; base < s.size(); base += 64) {
+        const char *block = s.data() + base;
+        if (s.size() - base < 64) {
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, s.size() - base);
+            block = tail;
+        }
+
+        // Characters preceded by an odd run of backslashes are escaped.
+        uint64_t backslash = blockMask(block, '\\');
+        uint64_t escaped;
+        if (!backslash) {
+            escaped = prev_escaped;
+            prev_escaped = 0;
+        } else {
+            backslash &= ~prev_escaped;
+            uint64_t follows_escape = backslash << 1 | prev_escaped;
+            uint64_t odd_starts = backslash & ~kEvenBits & ~follows_escape;
+            uint64_t even_sequences;
+            prev_escaped = __builtin_add_overflow(odd_starts, backslash, &even_sequences);
+            escaped = (kEvenBits ^ (even_sequences << 1)) & follows_escape;
+        }
+
+        uint64_t quote = blockMask(block, '"') & ~escaped;
+        uint64_t in_string = prefixXor(quote) ^ prev_in_string;
+        prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+        uint64_t structural = (blockAnyMask(block, kOperators) & ~in_string) | quote;
+        while (structural) {
+            pos.push_back(static_cast<uint32_t>(base + lowestBit(structural)));
+            structural &= structural - 1;
+        }
+    }
+    if (prev_in_string) return false;
+
+    // Pair the brackets, so skipping a container is one lookup.
+    match.assign(pos.size(), kScalar);
+    std::vector<uint32_t> &stack = scratch;
+    stack.clear();
+    for (uint32_t i = 0; i < pos.size(); i++) {
+        char c = s[pos[i]];
+        if (c == '{' || c == '[') {
+            stack.push_back(i);
+        } else if (c == '}' || c == ']') {
+            if (stack.empty()) return false;
+            char open = s[pos[stack.back()]];
+            if ((c == '}') != (open == '{')) return false;
+            match[stack.back()] = i;
+            stack.pop_back();
+        }
+    }
+    return stack.empty();
+}
+
+// Reads the value that starts after structural i (an opening bracket, ':' or ',').
+// next is set to the structural following the value.
+bool JsonIndex::valueAfter(uint32_t i, Value &out, uint32_t &next) const {
+    size_t start = (i == kScalar ? 0 : pos[i] + 1);
+    while (start < json.size() && isJsonSpace(json[start])) start++;
+    uint32_t j = (i == kScalar ? 0 : i + 1);
+    if (start >= json.size()) return false;
+
+    if (j < pos.size() && pos[j] == start) {
+        char c = json[start];
+        if (c == '"') {
+            if (j + 1 >= pos.size()) return false;
+            out = {json.substr(start, pos[j + 1] - start + 1), j};
+            next = j + 2;
+            return true;
+        }
+        if (c == '{' || c == '[') {
+            uint32_t close = match[j];
+            out = {json.substr(start, pos[close] - start + 1), j};
+            next = close + 1;
+            return true;
+        }
+        return false; // a bare operator where a value should be
+    }
+
+    size_t end = (j < pos.size() ? pos[j] : json.size());
+    while (end > start && isJsonSpace(json[end - 1])) end--;
+    if (end == start) return false;
+    out = {json.substr(start, end - start), kScalar};
+    next = j;
+    return true;
+}
+
+bool JsonIndex::Root(Value &out) const {
+    uint32_t next;
+    return valueAfter(kScalar, out, next);
+}
+
+bool JsonIndex::Element(const Value &array, size_t k, Value &out) const {
+    if (array.at == kScalar || json[pos[array.at]] != '[') return false;
+    uint32_t close = match[array.at];
+    uint32_t i = array.at;
+    if (i + 1 == close) return false; // []
+
+    for (size_t n = 0;; n++) {
+        uint32_t next;
+        if (!valueAfter(i, out, next) || next > close) return false;
+        if (n == k) return true;
+        if (next == close) return false;
+        i = next; // the ','
+    }
+}
+
+bool JsonIndex::Field(const Value &object, std::string_view key, Value &out) const {
+    if (object.at == kScalar || json[pos[object.at]] != '{') return false;
+    uint32_t close = match[object.at];
+    uint32_t i = object.at;
+    if (i + 1 == close) return false; // {}
+
+    while (i + 3 < close) {
+        // i: '{' or ',', i+1 and i+2: the key's quotes, i+3: ':'
+        if (json[pos[i + 1]] != '"' || json[pos[i + 3]] != ':') return false;
+        std::string_view name = json.substr(pos[i + 1] + 1, pos[i + 2] - pos[i + 1] - 1);
+        uint32_t next;
+        if (!valueAfter(i + 3, out, next) || next > close) return false;
+        if (name == key) return true;
+        i = next;
+    }
+    return false;
+}
+
+bool JsonIndex::String(const Value &v, std::string_view &out) {
+    if (v.text.size() < 2 || v.text.front() != '"') return false;
+    out = v.text.substr(1, v.text.size() - 2);
+    return true;
+}
+
+bool JsonIndex::Number(const Value &v, double &out) {
+    return parseNumber(v.text, out);
+}
@@ -0,0 +1,71 @@
+#ifndef JSON_INDEX_H
+#define JSON_INDEX_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+* Structural index of a JSON text with on-demand access to its values.
+*
+* Build() is the vectorized stage 1: it walks the text in 64-byte blocks,
+* resolves escapes and string boundaries with bit arithmetic and records
+* the position of every { } [ ] : , outside strings and of every unescaped
+* quote. Nothing is decoded up front. Root/Element/Field then move over the
+* index and only hand out slices of the text, which String/Number decode
+* when the caller asks for them.
+*
+* The vectors keep their capacity between frames, so reusing one index
+* does not allocate in steady state. Values point into the indexed text
+* and are only valid as long as it is.
+*/
+class JsonIndex {
+public:
+    struct Value {
+        std::string_view text; // the value as written, quotes included for strings
+        uint32_t at;           // structural index of its opening token, kScalar for bare values
+    };
+
+    static constexpr uint32_t kScalar = UINT32_MAX;
+
+    /*
+    * Index json, false if strings or brackets are not balanced.
+    */
+    bool Build(std::string_view json);
+
+    /*
+    * The top-level value.
+    */
+    bool Root(Value &out) const;
+
+    /*
+    * The k-th element of an array.
+    */
+    bool Element(const Value &array, size_t k, Value &out) const;
+
+    /*
+    * The member of an object with the given key, compared as written (escapes are not decoded).
+    */
+    bool Field(const Value &object, std::string_view key, Value &out) const;
+
+    /*
+    * The contents of a string value, escapes are left as written.
+    */
+    static bool String(const Value &v, std::string_view &out);
+
+    /*
+    * A number, bare or string-encoded as the simulator sends them.
+    */
+    static bool Number(const Value &v, double &out);
+
+    std::string_view json;
+    std::vector<uint32_t> pos;   // text offsets of the structural characters
+    std::vector<uint32_t> match; // for { and [ the structural index of the matching close
+
+private:
+    std::vector<uint32_t> scratch; // bracket stack for Build
+
+    bool valueAfter(uint32_t i, Value &out, uint32_t &next) const;
+};
+
+#endif /* JSON_INDEX_H */
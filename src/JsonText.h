@@ -0,0 +1,38 @@
+#ifndef JSON_TEXT_H
+#define JSON_TEXT_H
+
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+
+/*
+* Small pieces of JSON text handling shared by the telemetry decoder, the
+* frame scanner and the index. Inline, they sit in the hot loops of all three.
+*/
+
+/*
+* JSON insignificant whitespace.
+*/
+inline bool isJsonSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/*
+* Index of the first non-space at or after i, s.size() if there is none.
+*/
+inline size_t skipSpace(std::string_view s, size_t i) {
+    while (i < s.size() && isJsonSpace(s[i])) i++;
+    return i;
+}
+
+/*
+* A number that is either bare or wrapped in quotes, as the simulator sends
+* it. False unless the whole of v is the number.
+*/
+inline bool parseNumber(std::string_view v, double &out) {
+    if (v.size() >= 2 && v.front() == '"' && v.back() == '"') v = v.substr(1, v.size() - 2);
+    auto r = std::from_chars(v.data(), v.data() + v.size(), out);
+    return r.ec == std::errc() && r.ptr == v.data() + v.size();
+}
+
+#endif /* JSON_TEXT_H */
@@ -4,42 +4,24 @@
 
 using namespace std;
 
-/*
-* TODO: Complete the PID class.
-*/
-
 PID::PID() {}
 
 PID::~PID() {}
 
 void PID::Init(double Kp, double Ki, double Kd) {
-    PID::Kp = Kp;
-    PID::Ki = Ki;
-    PID::Kd = Kd;
-
-    PID::prev_cte = 0;
-    PID::int_cte = 0;
-    PID::n = 0;
-    PID::err = 0;
+    PIDT<Terms::PID>::Init(Kp, Ki, Kd);
 }
 
 double PID::UpdateError(double cte) {
-    n++;
-    double diff_cte = cte - prev_cte;
-    prev_cte = cte;
-    int_cte += cte;
-    err += (1 + fabs(cte)) * (1 + fabs(cte));
-
-    double steer = -Kp * cte - Kd * diff_cte - Ki * int_cte;
-    if (steer > 0.6) steer = 0.6;
-    if (steer < -0.6) steer = -0.6;
+    //std::cout << "CTE: " << cte << " diff_cte: " << cte - prev_cte << " int_cte: " << int_cte << std::endl;
 
-    //std::cout << "CTE: " << cte << " diff_cte: " << diff_cte << " int_cte: " << int_cte << std::endl;
+    return PIDT<Terms::PID>::UpdateError(cte);
+}
 
-    return steer;
+double PID::UpdateError(double cte, double dt) {
+    return PIDT<Terms::PID>::UpdateError(cte, dt);
 }
 
 double PID::TotalError() {
-    return err / n;
+    return PIDT<Terms::PID>::TotalError();
 }
-
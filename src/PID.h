@@ -1,7 +1,14 @@
 #ifndef PID_H
 #define PID_H
 
-class PID {
+#include "PIDT.h"
+
+/*
+* Runtime PID controller, every term enabled and the output clamped to
+* +-0.6. The work is done by PIDT<Terms::PID>, which also holds the
+* coefficients and state.
+*/
+class PID : public PIDT<Terms::PID> {
 public:
     /*
     * Errors
@@ -10,16 +17,6 @@ public:
     double i_error;
     double d_error;
 
-    /*
-    * Coefficients
-    */
-    double Kp;
-    double Ki;
-    double Kd;
-
-    double prev_cte, int_cte, err;
-    int n;
-
     /*
     * Constructor
     */
@@ -40,6 +37,11 @@ public:
     */
     double UpdateError(double cte);
 
+    /*
+    * Update given cross track error and the time since the last update, in nominal frame periods.
+    */
+    double UpdateError(double cte, double dt);
+
     /*
     * Calculate the total PID error.
     */
@@ -0,0 +1,96 @@
+#include "PIDBank.h"
+#include <cmath>
+#include <cstdint>
+
+#if !defined(PID_SCALAR) && (defined(__AVX512F__) || defined(__AVX2__))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const double kMaxSteer = 0.6;
+
+// One lane, in the same operation order as PID::UpdateError.
+inline double stepLane(double Kp, double Ki, double Kd, double &prev_cte, double &int_cte, double &err, double cte) {
+    double diff_cte = cte - prev_cte;
+    prev_cte = cte;
+    int_cte += cte;
+    err += (1 + std::fabs(cte)) * (1 + std::fabs(cte));
+
+    double steer = -Kp * cte - Kd * diff_cte - Ki * int_cte;
+    steer = steer > kMaxSteer ? kMaxSteer : steer;
+    steer = steer < -kMaxSteer ? -kMaxSteer : steer;
+    return steer;
+}
+
+}
+
+PIDBank::PIDBank(size_t size)
+        : Kp(size), Ki(size), Kd(size), prev_cte(size), int_cte(size), err(size), n(size) {}
+
+void PIDBank::Init(size_t lane, double Kp, double Ki, double Kd) {
+    PIDBank::Kp[lane] = Kp;
+    PIDBank::Ki[lane] = Ki;
+    PIDBank::Kd[lane] = Kd;
+
+    prev_cte[lane] = 0;
+    int_cte[lane] = 0;
+    n[lane] = 0;
+    err[lane] = 0;
+}
+
+void PIDBank::UpdateError(const double *cte, double *steer) {
+    size_t size = Size();
+    double *kp = Kp.data(), *ki = Ki.data(), *kd = Kd.data();
+    double *prev = prev_cte.data(), *integ = int_cte.data(), *e = err.data();
+    size_t k = 0;
+
+    // max(lo, x) and min(hi, x) return x when it is NaN, like the if-clamp in PID
+#if !defined(PID_SCALAR) && defined(__AVX512F__)
+    const __m512d one = _mm512_set1_pd(1), hi = _mm512_set1_pd(kMaxSteer), lo = _mm512_set1_pd(-kMaxSteer);
+    const __m512i sign = _mm512_set1_epi64(INT64_MIN);
+    for (; k + 8 <= size; k += 8) {
+        __m512d c = _mm512_loadu_pd(cte + k);
+        __m512d p = _mm512_loadu_pd(prev + k);
+        __m512d diff = _mm512_sub_pd(c, p);
+        __m512d in = _mm512_add_pd(_mm512_loadu_pd(integ + k), c);
+        __m512d a = _mm512_add_pd(one, _mm512_abs_pd(c));
+        _mm512_storeu_pd(prev + k, c);
+        _mm512_storeu_pd(integ + k, in);
+        _mm512_storeu_pd(e + k, _mm512_add_pd(_mm512_loadu_pd(e + k), _mm512_mul_pd(a, a)));
+
+        __m512d neg_kp = _mm512_castsi512_pd(_mm512_xor_si512(sign, _mm512_castpd_si512(_mm512_loadu_pd(kp + k))));
+        __m512d s = _mm512_mul_pd(neg_kp, c);
+        s = _mm512_sub_pd(s, _mm512_mul_pd(_mm512_loadu_pd(kd + k), diff));
+        s = _mm512_sub_pd(s, _mm512_mul_pd(_mm512_loadu_pd(ki + k), in));
+        _mm512_storeu_pd(steer + k, _mm512_min_pd(hi, _mm512_max_pd(lo, s)));
+    }
+#elif !defined(PID_SCALAR) && defined(__AVX2__)
+    const __m256d one = _mm256_set1_pd(1), hi = _mm256_set1_pd(kMaxSteer), lo = _mm256_set1_pd(-kMaxSteer);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    for (; k + 4 <= size; k += 4) {
+        __m256d c = _mm256_loadu_pd(cte + k);
+        __m256d p = _mm256_loadu_pd(prev + k);
+        __m256d diff = _mm256_sub_pd(c, p);
+        __m256d in = _mm256_add_pd(_mm256_loadu_pd(integ + k), c);
+        __m256d a = _mm256_add_pd(one, _mm256_andnot_pd(sign, c));
+        _mm256_storeu_pd(prev + k, c);
+        _mm256_storeu_pd(integ + k, in);
+        _mm256_storeu_pd(e + k, _mm256_add_pd(_mm256_loadu_pd(e + k), _mm256_mul_pd(a, a)));
+
+        __m256d s = _mm256_mul_pd(_mm256_xor_pd(sign, _mm256_loadu_pd(kp + k)), c);
+        s = _mm256_sub_pd(s, _mm256_mul_pd(_mm256_loadu_pd(kd + k), diff));
+        s = _mm256_sub_pd(s, _mm256_mul_pd(_mm256_loadu_pd(ki + k), in));
+        _mm256_storeu_pd(steer + k, _mm256_min_pd(hi, _mm256_max_pd(lo, s)));
+    }
+#endif
+    for (; k < size; k++) {
+        steer[k] = stepLane(kp[k], ki[k], kd[k], prev[k], integ[k], e[k], cte[k]);
+    }
+
+    for (auto &count : n) count++;
+}
+
+double PIDBank::TotalError(size_t lane) const {
+    return n[lane] ? err[lane] / n[lane] : 0;
+}
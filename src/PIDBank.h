@@ -0,0 +1,46 @@
+#ifndef PID_BANK_H
+#define PID_BANK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* N independent PID controllers stepped in lockstep. State is kept as
+* structure-of-arrays and UpdateError runs AVX-512, AVX2 or scalar kernels
+* over it with a branchless clamp. Every lane gives bit-identical results
+* to PID::UpdateError with the same gains and inputs.
+*/
+class PIDBank {
+public:
+    /*
+    * Coefficients, one entry per lane
+    */
+    std::vector<double> Kp;
+    std::vector<double> Ki;
+    std::vector<double> Kd;
+
+    std::vector<double> prev_cte, int_cte, err;
+    std::vector<int64_t> n;
+
+    explicit PIDBank(size_t size);
+
+    size_t Size() const { return Kp.size(); }
+
+    /*
+    * Initialize one lane, as PID::Init.
+    */
+    void Init(size_t lane, double Kp, double Ki, double Kd);
+
+    /*
+    * Step every lane with its cross track error, steer[k] gets lane k's output.
+    */
+    void UpdateError(const double *cte, double *steer);
+
+    /*
+    * Calculate the total error of one lane, as PID::TotalError.
+    */
+    double TotalError(size_t lane) const;
+};
+
+#endif /* PID_BANK_H */
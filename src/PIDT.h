@@ -0,0 +1,16 @@
+#ifndef PIDT_H
+#define PIDT_H
+
+#include "Pipeline.h"
+
+/*
+* PID controller specialized at compile time: the Controller pipeline with
+* only an output clamp. Disabled terms and their state updates are not
+* generated at all, and the clamp is a constant (Limit is a std::ratio, or
+* NoLimit). With every term enabled it computes exactly what PID does.
+* T can also be float or a fixed point type from Fixed.h.
+*/
+template<Terms terms, typename T = double, typename Limit = std::ratio<3, 5>>
+using PIDT = Controller<terms, T, Saturation<T, Limit>>;
+
+#endif /* PIDT_H */
@@ -0,0 +1,309 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cmath>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+
+/*
+* Terms a controller is built with.
+*/
+enum class Terms : unsigned {
+    P = 1,
+    I = 2,
+    D = 4,
+    PI = P | I,
+    PD = P | D,
+    PID = P | I | D
+};
+
+constexpr bool hasTerm(Terms terms, Terms t) {
+    return (static_cast<unsigned>(terms) & static_cast<unsigned>(t)) != 0;
+}
+
+/*
+* Limit tag for a stage that should not clamp.
+*/
+struct NoLimit {};
+
+/*
+* Base of the controller stages, every hook passes its input through.
+* A stage hides the hooks it needs; the calls are resolved at compile time.
+*/
+template<typename T>
+struct Stage {
+    void Reset() {}
+
+    /*
+    * Sees the cross track error of every update.
+    */
+    void Error(T cte) {}
+
+    /*
+    * Sees the error derivative before it is multiplied by Kd.
+    */
+    T Derivative(T diff_cte) { return diff_cte; }
+
+    /*
+    * Decides whether cte is added to the integral this update.
+    */
+    bool Integrate(T cte) { return true; }
+
+    /*
+    * Sees the output, in stage order. dt is 1 for fixed-step updates.
+    */
+    T Output(T steer, T dt) { return steer; }
+};
+
+/*
+* First order low-pass on the derivative, y += alpha * (x - y).
+* alpha = 1 passes it through.
+*/
+template<typename T>
+struct DerivativeLowPass : Stage<T> {
+    T alpha = 1;
+    T filtered = 0;
+
+    void Reset() { filtered = 0; }
+
+    T Derivative(T diff_cte) {
+        filtered = filtered + alpha * (diff_cte - filtered);
+        return filtered;
+    }
+};
+
+/*
+* Conditional integration: while the raw output is beyond Limit, cte that
+* would drive it further out is not integrated. Put it ahead of Saturation
+* so it sees the unclamped output. Assumes Ki >= 0.
+*/
+template<typename T, typename Limit = std::ratio<3, 5>>
+struct AntiWindup : Stage<T> {
+    int saturated = 0; // sign of the last raw output if it was beyond Limit
+
+    void Reset() { saturated = 0; }
+
+    bool Integrate(T cte) {
+        // -Ki * int_cte: positive cte pushes the output down
+        return !(saturated < 0 && cte > 0) && !(saturated > 0 && cte < 0);
+    }
+
+    T Output(T steer, T dt) {
+        const T limit = T(Limit::num) / T(Limit::den);
+        saturated = steer > limit ? 1 : steer < -limit ? -1 : 0;
+        return steer;
+    }
+};
+
+/*
+* Slew-rate limit, the output moves at most max_rate per nominal frame period.
+*/
+template<typename T>
+struct RateLimit : Stage<T> {
+    T max_rate = 1;
+    T last = 0;
+
+    void Reset() { last = 0; }
+
+    T Output(T steer, T dt) {
+        T step = max_rate * dt;
+        if (steer > last + step) steer = last + step;
+        if (steer < last - step) steer = last - step;
+        last = steer;
+        return steer;
+    }
+};
+
+/*
+* Clamp to +-Limit, a std::ratio. NoLimit makes it a no-op.
+*/
+template<typename T, typename Limit = std::ratio<3, 5>>
+struct Saturation : Stage<T> {
+    T Output(T steer, T dt) {
+        const T limit = T(Limit::num) / T(Limit::den);
+        if (steer > limit) steer = limit;
+        if (steer < -limit) steer = -limit;
+        return steer;
+    }
+};
+
+template<typename T>
+struct Saturation<T, NoLimit> : Stage<T> {};
+
+/*
+* The stages of a controller, in order. A plain aggregate rather than a
+* std::tuple so that it stays trivially copyable whenever the stages are.
+*/
+template<typename... Stages>
+struct StageList {
+    template<typename F>
+    void ForEach(F &&f) {}
+};
+
+template<typename S, typename... Rest>
+struct StageList<S, Rest...> {
+    S first;
+    StageList<Rest...> rest;
+
+    /*
+    * Call f on every stage, in order.
+    */
+    template<typename F>
+    void ForEach(F &&f) {
+        f(first);
+        rest.ForEach(f);
+    }
+
+    template<typename U>
+    U &Get() {
+        if constexpr (std::is_same_v<U, S>) return first;
+        else return rest.template Get<U>();
+    }
+};
+
+/*
+* PID controller followed by a chain of stages, all fixed at compile time:
+* disabled terms and their state are not generated, and the stages' hooks
+* are plain member calls that inline into UpdateError. With only a
+* Saturation stage it computes exactly what PID does, see PIDT.
+*/
+template<Terms terms, typename T, typename... Stages>
+class Controller {
+public:
+    static constexpr bool kP = hasTerm(terms, Terms::P);
+    static constexpr bool kI = hasTerm(terms, Terms::I);
+    static constexpr bool kD = hasTerm(terms, Terms::D);
+
+    /*
+    * Whether gain k (0: Kp, 1: Ki, 2: Kd) has any effect, for tuners.
+    */
+    static constexpr bool Uses(int k) {
+        return k == 0 ? kP : k == 1 ? kI : kD;
+    }
+
+    /*
+    * Coefficients, the ones of disabled terms are ignored
+    */
+    T Kp;
+    T Ki;
+    T Kd;
+
+    T prev_cte, int_cte;
+    double err; // sum of (1 + |cte|)^2, in double for every T: it grows with the run
+    int64_t n;
+
+    StageList<Stages...> stages;
+
+    /*
+    * Everything an update changes, stages included. Trivially copyable,
+    * so snapshots can be copied around and stored in bulk.
+    */
+    struct State {
+        T prev_cte, int_cte;
+        double err;
+        int64_t n;
+        StageList<Stages...> stages;
+    };
+
+    /*
+    * Initialize the controller and reset its stages, their parameters are kept.
+    */
+    void Init(T Kp, T Ki, T Kd) {
+        Controller::Kp = Kp;
+        Controller::Ki = Ki;
+        Controller::Kd = Kd;
+
+        Controller::prev_cte = 0;
+        Controller::int_cte = 0;
+        Controller::n = 0;
+        Controller::err = 0;
+        stages.ForEach([](auto &s) { s.Reset(); });
+    }
+
+    /*
+    * The stage of type S, to set its parameters.
+    */
+    template<typename S>
+    S &Get() { return stages.template Get<S>(); }
+
+    /*
+    * Capture the controller state, to branch several evaluations (with
+    * different gains, say) from the same point of a run.
+    */
+    State Snapshot() const {
+        static_assert(std::is_trivially_copyable_v<State>, "controller state must be trivially copyable");
+        return {prev_cte, int_cte, err, n, stages};
+    }
+
+    /*
+    * Return to a captured state. The gains are not part of it.
+    */
+    void Restore(const State &state) {
+        prev_cte = state.prev_cte;
+        int_cte = state.int_cte;
+        err = state.err;
+        n = state.n;
+        stages = state.stages;
+    }
+
+    /*
+    * Update the error variables given cross track error, returns the steering value.
+    */
+    T UpdateError(T cte) {
+        return update<false>(cte, T(1));
+    }
+
+    /*
+    * Same with the time since the previous update, dt > 0 in nominal frame
+    * periods. The derivative becomes a rate per period and the integral
+    * accumulates cte * dt, so gains tuned at a fixed step keep their meaning
+    * when frames arrive unevenly. dt = 1 gives UpdateError(cte).
+    */
+    T UpdateError(T cte, T dt) {
+        return update<true>(cte, dt);
+    }
+
+    /*
+    * Calculate the total error, 0 before the first update.
+    */
+    double TotalError() const {
+        return n ? err / n : 0;
+    }
+
+private:
+    template<bool timed>
+    T update(T cte, T dt) {
+        using std::fabs;
+        n++;
+        stages.ForEach([cte](auto &s) { s.Error(cte); });
+        T diff_cte = 0;
+        if constexpr (kD) {
+            diff_cte = cte - prev_cte;
+            if constexpr (timed) diff_cte = diff_cte / dt;
+            prev_cte = cte;
+            stages.ForEach([&diff_cte](auto &s) { diff_cte = s.Derivative(diff_cte); });
+        }
+        if constexpr (kI) {
+            bool integrate = true;
+            stages.ForEach([&](auto &s) { integrate = s.Integrate(cte) && integrate; });
+            if (integrate) {
+                if constexpr (timed) int_cte += cte * dt;
+                else int_cte += cte;
+            }
+        }
+        double e = 1 + static_cast<double>(fabs(cte));
+        err += e * e;
+
+        // same operation order as -Kp * cte - Kd * diff_cte - Ki * int_cte
+        T steer = 0;
+        if constexpr (kP) steer = -Kp * cte;
+        if constexpr (kD) steer = steer - Kd * diff_cte;
+        if constexpr (kI) steer = steer - Ki * int_cte;
+
+        stages.ForEach([&](auto &s) { steer = s.Output(steer, dt); });
+        return steer;
+    }
+};
+
+#endif /* PIPELINE_H */
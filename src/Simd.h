@@ -0,0 +1,109 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Byte-match masks over fixed-size blocks, AVX2 or SSE2 when the compiler
+* targets them, plain loops otherwise. Define PID_SCALAR to force the
+* fallback, e.g. to compare both paths.
+*/
+#if !defined(PID_SCALAR) && (defined(__AVX2__) || defined(__PCLMUL__))
+#include <immintrin.h>
+#endif
+
+#if !defined(PID_SCALAR) && defined(__AVX2__)
+
+const size_t kSimdWidth = 32;
+
+/*
+* Bit i of the result is set when p[i] == c, for the kSimdWidth bytes at p.
+*/
+inline uint64_t matchMask(const char *p, char c) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+}
+
+#elif !defined(PID_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+
+const size_t kSimdWidth = 16;
+
+inline uint64_t matchMask(const char *p, char c) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+}
+
+#else
+
+const size_t kSimdWidth = 16;
+
+inline uint64_t matchMask(const char *p, char c) {
+    uint64_t m = 0;
+    for (size_t i = 0; i < kSimdWidth; i++) m |= static_cast<uint64_t>(p[i] == c) << i;
+    return m;
+}
+
+#endif
+
+/*
+* Bit i of the result is set when p[i] is any of the characters in set.
+*/
+template<size_t N>
+inline uint64_t matchAnyMask(const char *p, const char (&set)[N]) {
+#if !defined(PID_SCALAR) && defined(__AVX2__)
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i any = _mm256_setzero_si256();
+    for (size_t k = 0; k + 1 < N; k++) any = _mm256_or_si256(any, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(set[k])));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(any));
+#elif !defined(PID_SCALAR) && defined(__SSE2__)
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i any = _mm_setzero_si128();
+    for (size_t k = 0; k + 1 < N; k++) any = _mm_or_si128(any, _mm_cmpeq_epi8(v, _mm_set1_epi8(set[k])));
+    return static_cast<uint32_t>(_mm_movemask_epi8(any));
+#else
+    uint64_t m = 0;
+    for (size_t k = 0; k + 1 < N; k++) m |= matchMask(p, set[k]);
+    return m;
+#endif
+}
+
+/*
+* 64-byte block versions of the masks above.
+*/
+inline uint64_t blockMask(const char *p, char c) {
+    uint64_t m = 0;
+    for (size_t i = 0; i < 64; i += kSimdWidth) m |= matchMask(p + i, c) << i;
+    return m;
+}
+
+template<size_t N>
+inline uint64_t blockAnyMask(const char *p, const char (&set)[N]) {
+    uint64_t m = 0;
+    for (size_t i = 0; i < 64; i += kSimdWidth) m |= matchAnyMask(p + i, set) << i;
+    return m;
+}
+
+/*
+* Bit i of the result is the xor of bits 0..i of m, carry-less multiply when available.
+*/
+inline uint64_t prefixXor(uint64_t m) {
+#if !defined(PID_SCALAR) && defined(__PCLMUL__)
+    return _mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, m), _mm_set1_epi8(-1), 0));
+#else
+    m ^= m << 1;
+    m ^= m << 2;
+    m ^= m << 4;
+    m ^= m << 8;
+    m ^= m << 16;
+    m ^= m << 32;
+    return m;
+#endif
+}
+
+inline int lowestBit(uint64_t m) { return __builtin_ctzll(m); }
+
+inline int highestBit(uint64_t m) { return 63 - __builtin_clzll(m); }
+
+#endif /* SIMD_H */
@@ -0,0 +1,59 @@
+#include "Simulator.h"
+#include <algorithm>
+
+Simulator::Simulator(const Track &track, SimConfig config)
+        : track(&track), config(config), rng(config.seed), noise(0.0, 1.0) {
+    Reset();
+}
+
+void Simulator::Reset() {
+    x = track->x[0];
+    y = track->y[0];
+    yaw = track->Heading(0);
+    speed = 0;
+    steering = 0;
+    position = track->Locate(x, y, 0);
+    distance = 0;
+    int slots = std::max(config.delay, 0) + 1;
+    pending_steer.assign(slots, 0.0);
+    pending_throttle.assign(slots, 0.0);
+    at = 0;
+    rng.seed(config.seed);
+    report();
+}
+
+// One noise draw per frame, so a copy of the simulator reports what the original would.
+void Simulator::report() {
+    double cte = position.cte;
+    if (config.cte_noise > 0) cte += config.cte_noise * noise(rng);
+    reported = {cte, speed * kMph, steering * config.max_steer};
+}
+
+Telemetry Simulator::Step(double steer, double throttle) {
+    // the command joins the ring, the one from delay frames ago comes out
+    pending_steer[at] = steer;
+    pending_throttle[at] = throttle;
+    at = (at + 1) % pending_steer.size();
+    steering = std::clamp(pending_steer[at], -1.0, 1.0);
+    double thr = std::clamp(pending_throttle[at], -1.0, 1.0);
+
+    // positive steering turns right, i.e. clockwise
+    double dt = config.dt;
+    double delta = steering * config.max_steer * kPi / 180;
+    double s0 = position.s;
+    x += speed * std::cos(yaw) * dt;
+    y += speed * std::sin(yaw) * dt;
+    yaw -= speed / config.wheelbase * std::tan(delta) * dt;
+
+    double accel = thr >= 0 ? thr * config.max_accel : thr * config.max_brake;
+    speed = std::max(0.0, speed + (accel - config.drag * speed * speed) * dt);
+
+    position = track->Locate(x, y, position.segment);
+    double ds = position.s - s0;
+    // across the start line
+    if (ds < -track->length / 2) ds += track->length;
+    if (ds > track->length / 2) ds -= track->length;
+    distance += ds;
+    report();
+    return reported;
+}
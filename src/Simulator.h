@@ -0,0 +1,132 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "Telemetry.h"
+#include "Track.h"
+#include "SpeedControl.h"
+#include "Drive.h"
+
+const double kMph = 2.23694; // per m/s
+const double kPi = 3.14159265358979323846;
+
+/*
+* Settings of the headless simulator. Steering and throttle are in the
+* units the controllers output, [-1, 1].
+*/
+struct SimConfig {
+    double dt = 0.05;             // s per frame
+    double wheelbase = 2.67;      // m
+    double max_steer = 25;        // degrees at steering 1, as in the Unity simulator
+    double max_accel = 4;         // m/s^2 at throttle 1
+    double max_brake = 8;         // m/s^2 at throttle -1
+    double drag = 0.0015;         // 1/m, deceleration drag * v^2
+    int delay = 2;                // frames before a command takes effect
+    double cte_noise = 0;         // m, standard deviation of the reported cte
+    uint64_t seed = 1;            // of the noise
+};
+
+/*
+* Kinematic bicycle model driving around a Track, one call per telemetry
+* frame. Step() applies the command sent delay frames ago, integrates
+* one frame and reports the same telemetry the Unity simulator sends,
+* cte in metres and speed in mph. Copyable, so a run can be branched.
+*/
+class Simulator {
+public:
+    Simulator(const Track &track, SimConfig config);
+
+    /*
+    * Back to the start line, at rest and aligned with the track.
+    */
+    void Reset();
+
+    Telemetry Step(double steer, double throttle);
+
+    /*
+    * Telemetry of the current frame without moving: what Reset or the
+    * last Step reported, the same noise sample every time.
+    */
+    const Telemetry &Observe() const { return reported; }
+
+    bool OffTrack() const { return std::fabs(position.cte) > track->half_width; }
+
+    double HalfWidth() const { return track->half_width; }
+
+    /*
+    * Metres driven along the centreline since Reset.
+    */
+    double Distance() const { return distance; }
+
+    const SimConfig &Config() const { return config; }
+
+    double x, y, yaw, speed; // m, m, rad counter-clockwise, m/s
+    double steering;         // applied steering, [-1, 1]
+
+private:
+    void report();
+
+    const Track *track;
+    SimConfig config;
+    Track::Position position;
+    double distance;
+    Telemetry reported; // this frame's, noise included
+
+    std::vector<double> pending_steer, pending_throttle; // ring of delay + 1 commands
+    size_t at;
+
+    std::mt19937_64 rng;
+    std::normal_distribution<double> noise;
+};
+
+/*
+* What an episode produced.
+*/
+struct EpisodeResult {
+    int frames;          // simulated, less than asked for when the car left the track
+    double total_error;  // as Controller::TotalError, frames after leaving the track count at half_width
+    double mean_speed;   // mph
+    double distance;     // m along the centreline
+    bool off_track;
+};
+
+/*
+* A point of a run that several episodes can start from: a copy of the car
+* and the controller states there, from Snapshot(). Copying it and calling
+* Restore() continues exactly as the run itself would have, without
+* replaying the frames before it.
+*/
+template<typename Steering>
+struct Branch {
+    Simulator sim;
+    typename Steering::State steering;
+    SpeedControl::State speed;
+};
+
+/*
+* Drive frames frames from the simulator's current state through drive(),
+* the controller step main() runs for every telemetry frame, with no socket
+* in between. The frames are evenly spaced, so this is main() without
+* --timed (a fixed step). Stops early when the car leaves the track.
+*/
+template<typename Steering>
+EpisodeResult runEpisode(Simulator &sim, Steering &steering, SpeedControl &speed, int frames,
+                         const GainSchedule *schedule = nullptr) {
+    Telemetry t = sim.Observe();
+    double err = 0, speed_sum = 0;
+    int k = 0;
+    for (; k < frames && !sim.OffTrack(); k++) {
+        Actuation a = drive(steering, speed, schedule, t.cte, t.speed, 0);
+        err += (1 + std::fabs(t.cte)) * (1 + std::fabs(t.cte));
+        speed_sum += t.speed;
+        t = sim.Step(a.steering_angle, a.throttle);
+    }
+    double off = 1 + sim.HalfWidth();
+    err += (frames - k) * off * off;
+    return {k, frames ? err / frames : 0, k ? speed_sum / k : 0, sim.Distance(), sim.OffTrack()};
+}
+
+#endif /* SIMULATOR_H */
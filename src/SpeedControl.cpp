@@ -0,0 +1,43 @@
+#include "SpeedControl.h"
+#include <cmath>
+
+void SpeedControl::Reset() {
+    loop.Init(Kp, Ki, 0);
+    speed_sum = 0;
+    frames = 0;
+}
+
+double SpeedControl::Target(double cte, double steer) const {
+    double target = max_speed - cte_slowdown * std::fabs(cte) - steer_slowdown * std::fabs(steer);
+    return std::fmax(target, min_speed);
+}
+
+double SpeedControl::Update(double speed, double cte, double steer, double dt) {
+    speed_sum += speed;
+    frames++;
+
+    loop.Kp = Kp;
+    loop.Ki = Ki;
+    double error = speed - Target(cte, steer);
+    return dt > 0 ? loop.UpdateError(error, dt) : loop.UpdateError(error);
+}
+
+double &SpeedControl::Param(int k) {
+    switch (k) {
+        case 0:
+            return Kp;
+        case 1:
+            return Ki;
+        case 2:
+            return max_speed;
+        case 3:
+            return cte_slowdown;
+        default:
+            return steer_slowdown;
+    }
+}
+
+const char *SpeedControl::ParamName(int k) {
+    static const char *names[kParams] = {"Kp", "Ki", "max_speed", "cte_slowdown", "steer_slowdown"};
+    return names[k];
+}
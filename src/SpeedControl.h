@@ -0,0 +1,83 @@
+#ifndef SPEED_CONTROL_H
+#define SPEED_CONTROL_H
+
+#include <cstdint>
+#include <ratio>
+#include "Pipeline.h"
+
+/*
+* Throttle from a target speed profile and a PI loop on the speed error.
+*
+* The target starts at max_speed and drops by cte_slowdown per unit of
+* |cte| and steer_slowdown per unit of |steering| (tight corners need a
+* lot of steering), never below min_speed. It runs after steering on the
+* same telemetry, with that frame's steering value. Throttle is clamped to
+* +-1, negative brakes.
+*/
+class SpeedControl {
+public:
+    /*
+    * Tunable parameters, see Param()
+    */
+    static constexpr int kParams = 5;
+
+    double Kp = 0.2;
+    double Ki = 0.002;
+    double max_speed = 35;
+    double cte_slowdown = 10;
+    double steer_slowdown = 30;
+    double min_speed = 15;
+
+    SpeedControl() { Reset(); }
+
+    /*
+    * Reset the loop state and the mean speed, the parameters are kept.
+    */
+    void Reset();
+
+    double Target(double cte, double steer) const;
+
+    /*
+    * Throttle for this frame. dt as for Controller::UpdateError, 0 for a fixed step.
+    */
+    double Update(double speed, double cte, double steer, double dt = 0);
+
+    /*
+    * Mean reported speed since the last Reset.
+    */
+    double MeanSpeed() const { return frames ? speed_sum / frames : 0; }
+
+    /*
+    * Parameter k for tuners: Kp, Ki, max_speed, cte_slowdown, steer_slowdown.
+    */
+    double &Param(int k);
+
+    static const char *ParamName(int k);
+
+    // positive error (too fast) pushes the output down, like cte does for steering
+    using Loop = Controller<Terms::PI, double, AntiWindup<double, std::ratio<1>>, Saturation<double, std::ratio<1>>>;
+
+    /*
+    * Loop state and mean speed, as Controller::State; the parameters are not part of it.
+    */
+    struct State {
+        Loop::State loop;
+        double speed_sum;
+        int64_t frames;
+    };
+
+    State Snapshot() const { return {loop.Snapshot(), speed_sum, frames}; }
+
+    void Restore(const State &state) {
+        loop.Restore(state.loop);
+        speed_sum = state.speed_sum;
+        frames = state.frames;
+    }
+
+private:
+    Loop loop;
+    double speed_sum = 0;
+    int64_t frames = 0;
+};
+
+#endif /* SPEED_CONTROL_H */
@@ -0,0 +1,216 @@
+#include "Telemetry.h"
+#include "JsonText.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+const std::string_view kTelemetryEvent = "\"telemetry\"";
+
+// Returns the index just past the closing quote of the string starting at s[i] == '"'.
+size_t skipString(std::string_view s, size_t i) {
+    for (i++; i < s.size(); i++) {
+        if (s[i] == '\\') i++;
+        else if (s[i] == '"') return i + 1;
+    }
+    return std::string_view::npos;
+}
+
+// Returns the index just past the value starting at s[i], nested containers included.
+size_t skipValue(std::string_view s, size_t i) {
+    int depth = 0;
+    while (i < s.size()) {
+        char c = s[i];
+        if (c == '"') {
+            i = skipString(s, i);
+            if (i == std::string_view::npos) return i;
+            if (depth == 0) return i;
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) return i;
+            if (--depth == 0) return i + 1;
+        } else if (c == ',' && depth == 0) {
+            return i;
+        }
+        i++;
+    }
+    return std::string_view::npos;
+}
+
+// Appends literal text, returns nullptr when it does not fit.
+char *put(char *p, char *end, std::string_view text) {
+    if (p == nullptr || static_cast<size_t>(end - p) < text.size()) return nullptr;
+    std::memcpy(p, text.data(), text.size());
+    return p + text.size();
+}
+
+// Appends a double the way JSON expects it, non-finite values become null.
+// With real set, integral values keep a ".0" so they read back as floats,
+// as json::dump wrote them.
+char *putNumber(char *p, char *end, double value, bool real) {
+    if (p == nullptr) return nullptr;
+    if (!std::isfinite(value)) return put(p, end, "null");
+    auto r = std::to_chars(p, end, value);
+    if (r.ec != std::errc()) return nullptr;
+    if (real && std::string_view(p, r.ptr - p).find_first_of(".e") == std::string_view::npos)
+        return put(r.ptr, end, ".0");
+    return r.ptr;
+}
+
+
+uint64_t loadLE64(const char *p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+void storeLE64(char *p, uint64_t v) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    std::memcpy(p, &v, sizeof(v));
+}
+
+double loadDouble(const char *p) {
+    uint64_t bits = loadLE64(p);
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+void storeDouble(char *p, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    storeLE64(p, bits);
+}
+
+}
+
+bool decodeTelemetry(std::string_view s, Telemetry &t, std::string_view *object) {
+    size_t i = skipSpace(s, 0);
+    if (i >= s.size() || s[i] != '[') return false;
+    i = skipSpace(s, i + 1);
+    if (s.compare(i, kTelemetryEvent.size(), kTelemetryEvent) != 0) return false;
+    i = skipSpace(s, i + kTelemetryEvent.size());
+    if (i >= s.size() || s[i] != ',') return false;
+    i = skipSpace(s, i + 1);
+    if (i >= s.size() || s[i] != '{') return false;
+    if (object) {
+        // the array closes right after the object
+        size_t end = s.size();
+        while (end > i && (isJsonSpace(s[end - 1]) || s[end - 1] == ']')) end--;
+        *object = s.substr(i, end - i);
+    }
+    i++;
+
+    unsigned found = 0;
+    while (found != 7) {
+        i = skipSpace(s, i);
+        if (i >= s.size() || s[i] != '"') return false;
+        size_t key_end = skipString(s, i);
+        if (key_end == std::string_view::npos) return false;
+        std::string_view key = s.substr(i + 1, key_end - i - 2);
+
+        i = skipSpace(s, key_end);
+        if (i >= s.size() || s[i] != ':') return false;
+        i = skipSpace(s, i + 1);
+        size_t value_end = skipValue(s, i);
+        if (value_end == std::string_view::npos) return false;
+        std::string_view value = s.substr(i, value_end - i);
+        while (!value.empty() && isJsonSpace(value.back())) value.remove_suffix(1);
+
+        if (key == "cte") {
+            if (!parseNumber(value, t.cte)) return false;
+            found |= 1;
+        } else if (key == "speed") {
+            if (!parseNumber(value, t.speed)) return false;
+            found |= 2;
+        } else if (key == "steering_angle") {
+            if (!parseNumber(value, t.steering_angle)) return false;
+            found |= 4;
+        }
+        if (found == 7) break;
+
+        i = skipSpace(s, value_end);
+        if (i >= s.size() || s[i] != ',') return false;
+        i++;
+    }
+    return true;
+}
+
+TelemetryView::TelemetryView(const Telemetry &t) : Telemetry(t) {}
+
+TelemetryView::TelemetryView(const Telemetry &t, std::string_view object, JsonIndex &index)
+        : Telemetry(t), object(object), index(&index) {}
+
+bool TelemetryView::field(std::string_view key, JsonIndex::Value &out) const {
+    if (index == nullptr) return false;
+    if (!indexed) {
+        // first lazy access for this frame, index the object once
+        indexed = true;
+        if (!index->Build(object) || !index->Root(root)) root.at = JsonIndex::kScalar;
+    }
+    return index->Field(root, key, out);
+}
+
+bool TelemetryView::Number(std::string_view key, double &out) const {
+    for (size_t k = 0; k < cached; k++) {
+        if (cache[k].Key() == key) {
+            out = cache[k].value;
+            return cache[k].ok;
+        }
+    }
+
+    JsonIndex::Value v;
+    double value = 0;
+    bool ok = field(key, v) && JsonIndex::Number(v, value);
+    if (cached < std::size(cache) && key.size() <= sizeof(Entry::key)) {
+        Entry &e = cache[cached++];
+        std::memcpy(e.key, key.data(), key.size());
+        e.length = static_cast<unsigned char>(key.size());
+        e.value = value;
+        e.ok = ok;
+    }
+    out = value;
+    return ok;
+}
+
+bool TelemetryView::String(std::string_view key, std::string_view &out) const {
+    JsonIndex::Value v;
+    return field(key, v) && JsonIndex::String(v, out);
+}
+
+size_t encodeSteer(char *buf, size_t size, double steering_angle, double throttle) {
+    char *end = buf + size;
+    char *p = put(buf, end, "42[\"steer\",{\"steering_angle\":");
+    p = putNumber(p, end, steering_angle, true);
+    p = put(p, end, ",\"throttle\":");
+    p = putNumber(p, end, throttle, false);
+    p = put(p, end, "}]");
+    return p == nullptr ? 0 : p - buf;
+}
+
+bool decodeBinaryTelemetry(std::string_view s, Telemetry &t, uint64_t &seq) {
+    if (s.size() != kBinaryTelemetrySize) return false;
+    seq = loadLE64(s.data());
+    t.cte = loadDouble(s.data() + 8);
+    t.speed = loadDouble(s.data() + 16);
+    t.steering_angle = loadDouble(s.data() + 24);
+    return true;
+}
+
+size_t encodeBinarySteer(char *buf, size_t size, uint64_t seq, double steering_angle, double throttle) {
+    if (size < kBinarySteerSize) return 0;
+    storeLE64(buf, seq);
+    storeDouble(buf + 8, steering_angle);
+    storeDouble(buf + 16, throttle);
+    return kBinarySteerSize;
+}
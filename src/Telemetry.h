@@ -0,0 +1,115 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "JsonIndex.h"
+
+/*
+* Fields of the simulator telemetry event the controller acts on.
+*/
+struct Telemetry {
+    double cte;
+    double speed;
+    double steering_angle;
+};
+
+/*
+* Decode the socket.io array ["telemetry",{...}] without building a JSON DOM.
+* The three keys are located in a single pass over the object and their
+* string-encoded values are parsed in place with std::from_chars.
+* Returns false for any other event or layout, the caller should then fall
+* back to the generic JSON parser. If object is given it receives the whole
+* {...} payload, for lazy access to the fields not decoded here.
+*/
+bool decodeTelemetry(std::string_view s, Telemetry &t, std::string_view *object = nullptr);
+
+/*
+* Telemetry as handed to the controller. cte, speed and steering_angle are
+* decoded eagerly, any other field of the event (position, yaw, timestamp,
+* whatever the simulator adds) is only looked up and decoded the first time
+* it is asked for, so new protocol fields cost nothing unless they are used.
+* The view borrows the frame and an index to parse it with, both must
+* outlive it.
+*/
+class TelemetryView : public Telemetry {
+public:
+    /*
+    * A view with only the eager fields, e.g. from a binary frame.
+    */
+    explicit TelemetryView(const Telemetry &t);
+
+    TelemetryView(const Telemetry &t, std::string_view object, JsonIndex &index);
+
+    /*
+    * A numeric field, bare or string-encoded. False if it is absent or not a number.
+    */
+    bool Number(std::string_view key, double &out) const;
+
+    /*
+    * A string field as written, escapes are not decoded.
+    */
+    bool String(std::string_view key, std::string_view &out) const;
+
+private:
+    // the key is copied, a view could outlive the caller's string; longer keys aren't cached
+    struct Entry {
+        char key[24];
+        unsigned char length;
+        double value;
+        bool ok;
+
+        std::string_view Key() const { return {key, length}; }
+    };
+
+    bool field(std::string_view key, JsonIndex::Value &out) const;
+
+    std::string_view object;
+    JsonIndex *index = nullptr;
+    mutable bool indexed = false;
+    mutable JsonIndex::Value root{};
+    mutable Entry cache[8];
+    mutable size_t cached = 0;
+};
+
+/*
+* Frames that never change, sent as is from static storage.
+*/
+constexpr std::string_view kResetFrame = "42[\"reset\", {}]";
+constexpr std::string_view kManualFrame = "42[\"manual\",{}]";
+
+/*
+* Largest frame encodeSteer can produce, sized for two shortest round-trip doubles.
+*/
+const size_t kMaxSteerFrame = 96;
+
+/*
+* Write 42["steer",{"steering_angle":..,"throttle":..}] into buf, the same
+* key order and layout json::dump produced, with each double in its shortest
+* round-trip form (integral steering values keep their ".0").
+* Returns the frame length, or 0 if buf is too small.
+*/
+size_t encodeSteer(char *buf, size_t size, double steering_angle, double throttle);
+
+/*
+* Binary protocol for local harnesses, sent as websocket BINARY frames.
+* Telemetry: uint64 seq, double cte, double speed, double steering_angle.
+* Steer reply: uint64 seq (echoed), double steering_angle, double throttle.
+* All fields little-endian, no padding. Reset requests stay socket.io text frames.
+*/
+const size_t kBinaryTelemetrySize = 32;
+const size_t kBinarySteerSize = 24;
+static_assert(kBinarySteerSize <= kMaxSteerFrame, "steer replies share one buffer");
+
+/*
+* Decode a binary telemetry frame, false if it has the wrong size.
+*/
+bool decodeBinaryTelemetry(std::string_view s, Telemetry &t, uint64_t &seq);
+
+/*
+* Write a binary steer reply into buf, returns its length or 0 if buf is too small.
+*/
+size_t encodeBinarySteer(char *buf, size_t size, uint64_t seq, double steering_angle, double throttle);
+
+#endif /* TELEMETRY_H */
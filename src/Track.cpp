@@ -0,0 +1,102 @@
+#include "Track.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+Track Track::Loop() {
+    // radius modulated around the loop, slow harmonics give sweepers, the
+    // faster one a few tight corners
+    Track t;
+    const int points = 2400;
+    const double pi = std::acos(-1.0);
+    for (int k = 0; k < points; k++) {
+        double a = 2 * pi * k / points;
+        double r = 180 * (1 + 0.22 * std::sin(2 * a) + 0.12 * std::cos(3 * a + 0.4) + 0.06 * std::sin(5 * a));
+        t.x.push_back(r * std::cos(a));
+        t.y.push_back(r * std::sin(a));
+    }
+    t.measure();
+    return t;
+}
+
+Track Track::Load(const std::string &path) {
+    Track t;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        double px, py;
+        if (fields >> px >> py) {
+            t.x.push_back(px);
+            t.y.push_back(py);
+        }
+    }
+    if (t.x.size() < 3) return Track();
+    t.measure();
+    return t;
+}
+
+void Track::measure() {
+    size_t count = x.size();
+    s.resize(count);
+    dx.resize(count);
+    dy.resize(count);
+    inv_len2.resize(count);
+    len.resize(count);
+    double d = 0;
+    for (size_t k = 0; k < count; k++) {
+        size_t n = (k + 1) % count;
+        dx[k] = x[n] - x[k];
+        dy[k] = y[n] - y[k];
+        len[k] = std::hypot(dx[k], dy[k]);
+        inv_len2[k] = 1 / (dx[k] * dx[k] + dy[k] * dy[k]);
+        s[k] = d;
+        d += len[k];
+    }
+    length = d;
+}
+
+double Track::Heading(size_t segment) const {
+    return std::atan2(dy[segment], dx[segment]);
+}
+
+// Squared distance from a point to a segment.
+double Track::distance2(size_t segment, double px, double py) const {
+    double ax = px - x[segment], ay = py - y[segment];
+    double t = (ax * dx[segment] + ay * dy[segment]) * inv_len2[segment];
+    t = t < 0 ? 0 : t > 1 ? 1 : t;
+    double ex = t * dx[segment] - ax, ey = t * dy[segment] - ay;
+    return ex * ex + ey * ey;
+}
+
+Track::Position Track::Locate(double px, double py, size_t hint) const {
+    size_t count = x.size();
+    size_t best = hint % count;
+    double best_d = distance2(best, px, py);
+
+    // walk downhill either way; a car moves less than a segment or two per frame
+    for (int dir : {1, -1}) {
+        size_t k = best;
+        for (size_t step = 0; step < count / 2; step++) {
+            size_t next = dir > 0 ? (k + 1) % count : (k + count - 1) % count;
+            double d = distance2(next, px, py);
+            if (d >= best_d) break;
+            best_d = d;
+            best = k = next;
+        }
+    }
+
+    return Project(best, px, py);
+}
+
+Track::Position Track::Project(size_t segment, double px, double py) const {
+    double ax = px - x[segment], ay = py - y[segment];
+    double t = (ax * dx[segment] + ay * dy[segment]) * inv_len2[segment];
+    t = t < 0 ? 0 : t > 1 ? 1 : t;
+    double ex = t * dx[segment] - ax, ey = t * dy[segment] - ay;
+    double d = std::sqrt(ex * ex + ey * ey);
+    // the cross product is positive to the left of the segment
+    double cross = dx[segment] * ay - dy[segment] * ax;
+    return {segment, cross > 0 ? -d : d, s[segment] + t * len[segment]};
+}
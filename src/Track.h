@@ -0,0 +1,63 @@
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <string>
+#include <vector>
+
+/*
+* Closed track centreline as a polyline, in metres. The last point joins
+* back to the first.
+*/
+class Track {
+public:
+    std::vector<double> x, y;
+    std::vector<double> s;  // distance along the centreline at each point
+    double length = 0;      // of the whole loop
+    double half_width = 4;  // the car is off the track beyond this |cte|
+
+    // per segment, from point k to the next: direction, 1 / length^2 and length
+    std::vector<double> dx, dy, inv_len2, len;
+
+    /*
+    * A lake-like loop of about 1.2 km with fast sweepers and a few tight corners.
+    */
+    static Track Loop();
+
+    /*
+    * Read "x y" per line, # lines are comments. Empty if it can't.
+    */
+    static Track Load(const std::string &path);
+
+    size_t Size() const { return x.size(); }
+
+    /*
+    * Where a point is relative to the centreline. Segment is the closest
+    * one, found by walking from hint; pass the previous result to make it
+    * O(1) per step. cte is positive to the right of the driving direction.
+    */
+    struct Position {
+        size_t segment;
+        double cte;
+        double s; // distance along the loop of the closest centreline point
+    };
+
+    Position Locate(double px, double py, size_t hint) const;
+
+    /*
+    * Where a point is relative to one given segment: the tail of Locate
+    * once the closest segment is known.
+    */
+    Position Project(size_t segment, double px, double py) const;
+
+    /*
+    * Heading of the centreline at a segment, radians.
+    */
+    double Heading(size_t segment) const;
+
+private:
+    void measure();
+
+    double distance2(size_t segment, double px, double py) const;
+};
+
+#endif /* TRACK_H */
@@ -0,0 +1,168 @@
+#include "Tuner.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+Tuner::Tuner(std::vector<double> params, std::vector<double> steps, double tolerance)
+        : candidate(std::move(params)), steps(std::move(steps)), tolerance(tolerance), best(candidate),
+          best_cost(std::numeric_limits<double>::infinity()) {
+    Tuner::steps.resize(candidate.size(), 0);
+    // start on the first parameter that moves
+    while (par < candidate.size() && Tuner::steps[par] == 0) par++;
+    if (par == candidate.size()) par = 0;
+}
+
+double Tuner::StepSum() const {
+    double sum = 0;
+    for (double s : steps) sum += s;
+    return sum;
+}
+
+bool Tuner::Done() const {
+    return StepSum() <= tolerance;
+}
+
+// Moves to the next parameter with a step, counting wrap-arounds as iterations.
+void Tuner::next() {
+    for (size_t k = 0; k < candidate.size(); k++) {
+        if (++par == candidate.size()) {
+            par = 0;
+            iteration++;
+        }
+        if (steps[par] != 0) return;
+    }
+}
+
+void Tuner::Tell(double cost) {
+    bool improved = cost < best_cost;
+    if (improved) {
+        best_cost = cost;
+        best = candidate;
+    }
+
+    switch (state) {
+        case 0: // baseline
+            state = 1;
+            candidate[par] += steps[par];
+            break;
+        case 1: // +step
+            if (improved) {
+                steps[par] *= 1.1;
+                next();
+                candidate[par] += steps[par];
+            } else {
+                candidate[par] -= 2. * steps[par];
+                state = 2;
+            }
+            break;
+        case 2: // -step
+            if (improved) {
+                steps[par] *= 1.1;
+            } else {
+                candidate[par] += steps[par];
+                steps[par] *= 0.9;
+            }
+            next();
+            state = 1;
+            candidate[par] += steps[par];
+            break;
+    }
+}
+
+ParallelTuner::ParallelTuner(std::vector<double> params, std::vector<double> steps, double tolerance)
+        : center(std::move(params)), center_cost(std::numeric_limits<double>::infinity()),
+          steps(std::move(steps)), tolerance(tolerance), best(center),
+          best_cost(std::numeric_limits<double>::infinity()) {
+    ParallelTuner::steps.resize(center.size(), 0);
+    propose();
+}
+
+double ParallelTuner::StepSum() const {
+    double sum = 0;
+    for (double s : steps) sum += s;
+    return sum;
+}
+
+bool ParallelTuner::Done() const {
+    return StepSum() <= tolerance;
+}
+
+void ParallelTuner::propose() {
+    batch.clear();
+    probed.clear();
+    if (!center_known) batch.push_back(center);
+    for (size_t k = 0; k < center.size(); k++) {
+        if (steps[k] == 0) continue;
+        probed.push_back(k);
+        batch.push_back(center);
+        batch.back()[k] += steps[k];
+        batch.push_back(center);
+        batch.back()[k] -= steps[k];
+    }
+}
+
+void ParallelTuner::Tell(const std::vector<double> &costs) {
+    rounds++;
+    size_t first = 0;
+    double before = best_cost;
+    if (!center_known) {
+        center_cost = costs[0];
+        center_known = true;
+        first = 1;
+    }
+    for (size_t k = 0; k < batch.size(); k++) {
+        if (costs[k] < best_cost) {
+            best_cost = costs[k];
+            best = batch[k];
+        }
+    }
+
+    if (combined && center_cost > before) {
+        // the combined step overshot, go back to the best point before it
+        combined = false;
+        auto probe = std::min_element(costs.begin() + first, costs.end());
+        if (probe != costs.end() && *probe < before) {
+            // unless a probe around the overshoot already beats that
+            center = batch[probe - costs.begin()];
+            center_cost = *probe;
+        } else {
+            center = best;
+            center_cost = best_cost;
+            for (double &s : steps) s *= 0.9;
+        }
+        propose();
+        return;
+    }
+
+    bool moved = false;
+    for (size_t j = 0; j < probed.size(); j++) {
+        size_t k = probed[j];
+        double plus = costs[first + 2 * j], minus = costs[first + 2 * j + 1];
+        if (std::min(plus, minus) < center_cost) {
+            center[k] += plus <= minus ? steps[k] : -steps[k];
+            steps[k] *= 1.1;
+            moved = true;
+        } else {
+            steps[k] *= 0.9;
+        }
+    }
+    combined = moved;
+    center_known = !moved;
+    propose();
+}
+
+void ParallelTuner::Run(const std::function<double(const std::vector<double> &)> &cost, int max_rounds,
+                        WorkPool &pool) {
+    for (int r = 0; r < max_rounds && !Done(); r++) {
+        const auto &candidates = Ask();
+        std::vector<double> costs(candidates.size());
+        pool.Run(candidates.size(), [&](size_t k) { costs[k] = cost(candidates[k]); });
+        Tell(costs);
+    }
+}
+
+void ParallelTuner::Run(const std::function<double(const std::vector<double> &)> &cost, int max_rounds,
+                        unsigned threads) {
+    WorkPool pool(threads);
+    Run(cost, max_rounds, pool);
+}
@@ -0,0 +1,147 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "WorkPool.h"
+
+/*
+* Twiddle (coordinate descent with adaptive steps) as an ask/tell engine.
+* Ask() is the parameter set to evaluate next, Tell() takes its cost; all
+* search state stays in here, so any evaluator can drive it at its own
+* pace: the live simulator, a headless one, or a recorded trace.
+*
+* Every parameter is tried at +step and, if that doesn't improve, -step.
+* A step grows by 10% when it improves and shrinks by 10% when neither
+* side does. A parameter with a zero step is left alone. Tuning is done
+* when the steps sum to tolerance or less.
+*/
+class Tuner {
+public:
+    Tuner(std::vector<double> params, std::vector<double> steps, double tolerance);
+
+    /*
+    * The candidate to evaluate next.
+    */
+    const std::vector<double> &Ask() const { return candidate; }
+
+    /*
+    * The cost of the last candidate Ask() returned, lower is better.
+    */
+    void Tell(double cost);
+
+    bool Done() const;
+
+    /*
+    * Best candidate so far and its cost (infinity before the first Tell).
+    * An evaluation already costing more can be cut short.
+    */
+    const std::vector<double> &Best() const { return best; }
+
+    double BestCost() const { return best_cost; }
+
+    const std::vector<double> &Steps() const { return steps; }
+
+    double StepSum() const;
+
+    /*
+    * Full passes over the parameters so far.
+    */
+    int Iteration() const { return iteration; }
+
+    /*
+    * Ask, evaluate with cost(params) and tell until done or max_evaluations.
+    */
+    template<typename F>
+    void Run(F &&cost, int max_evaluations) {
+        for (int k = 0; k < max_evaluations && !Done(); k++) Tell(cost(Ask()));
+    }
+
+private:
+    void next();
+
+    std::vector<double> candidate;
+    std::vector<double> steps;
+    double tolerance;
+
+    std::vector<double> best;
+    double best_cost;
+    size_t par = 0;
+    int state = 0; // 0: baseline not evaluated, 1: +step under evaluation, 2: -step
+    int iteration = 0;
+};
+
+/*
+* Twiddle probing every parameter at once, for evaluators that can run
+* side by side. A round is centre +- step for every parameter with a step
+* (plus the centre itself when its cost isn't known yet), all handed out
+* together by Ask(). Each parameter whose better side beats the centre
+* moves there, all of them in one combined step, and steps grow or shrink
+* as in Tuner. If the combined centre turns out worse than the best point
+* seen before it, the centre falls back to that point and the round's
+* probes around it are dropped.
+*
+* A round costs 2 evaluations per parameter but takes one evaluation's
+* wall-clock time given enough evaluators.
+*/
+class ParallelTuner {
+public:
+    ParallelTuner(std::vector<double> params, std::vector<double> steps, double tolerance);
+
+    /*
+    * The candidates of this round, evaluated in any order.
+    */
+    const std::vector<std::vector<double>> &Ask() const { return batch; }
+
+    /*
+    * Costs of the Ask() candidates, in the same order.
+    */
+    void Tell(const std::vector<double> &costs);
+
+    bool Done() const;
+
+    const std::vector<double> &Best() const { return best; }
+
+    double BestCost() const { return best_cost; }
+
+    const std::vector<double> &Steps() const { return steps; }
+
+    double StepSum() const;
+
+    /*
+    * Rounds so far.
+    */
+    int Iteration() const { return rounds; }
+
+    /*
+    * Evaluate each round's candidates on the pool until done or max_rounds.
+    * cost is called concurrently.
+    */
+    void Run(const std::function<double(const std::vector<double> &)> &cost, int max_rounds, WorkPool &pool);
+
+    /*
+    * The same on a pool of threads workers (0: one per core).
+    */
+    void Run(const std::function<double(const std::vector<double> &)> &cost, int max_rounds, unsigned threads = 0);
+
+private:
+    void propose();
+
+    std::vector<double> center;
+    double center_cost;
+    bool center_known = false;
+    bool combined = false; // the centre is a combined move not yet evaluated
+
+    std::vector<double> steps;
+    double tolerance;
+
+    std::vector<double> best;
+    double best_cost;
+
+    std::vector<std::vector<double>> batch;
+    std::vector<size_t> probed; // parameter of batch probes 2j and 2j + 1, after the centre
+    int rounds = 0;
+};
+
+#endif /* TUNER_H */
@@ -0,0 +1,97 @@
+#include "WorkPool.h"
+#include <algorithm>
+
+WorkPool::WorkPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned w = 0; w < threads; w++) queues.emplace_back(new Queue);
+    for (unsigned w = 1; w < threads; w++) workers.emplace_back([this, w]() { serve(w); });
+}
+
+WorkPool::~WorkPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto &t : workers) t.join();
+}
+
+void WorkPool::Run(size_t tasks, const std::function<void(size_t)> &task) {
+    // every worker is idle here, so the deques can be filled before waking them
+    size_t count = queues.size();
+    for (size_t w = 0; w < count; w++) {
+        std::lock_guard<std::mutex> guard(queues[w]->lock);
+        for (size_t k = tasks * w / count; k < tasks * (w + 1) / count; k++) queues[w]->tasks.push_back(k);
+    }
+    stolen = 0;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        job = &task;
+        busy = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+    drain(0, task);
+
+    // a worker still looking for work could otherwise steal from the next Run
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [this]() { return busy == 0; });
+    job = nullptr;
+}
+
+void WorkPool::serve(unsigned self) {
+    uint64_t seen = 0;
+    for (;;) {
+        const std::function<void(size_t)> *task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this, seen]() { return stop || generation != seen; });
+            if (stop) return;
+            seen = generation;
+            task = job;
+        }
+        drain(self, *task);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            busy--;
+        }
+        done.notify_one();
+    }
+}
+
+void WorkPool::drain(unsigned self, const std::function<void(size_t)> &task) {
+    size_t k;
+    while (pop(self, k) || steal(self, k)) task(k);
+}
+
+bool WorkPool::pop(unsigned self, size_t &task) {
+    Queue &q = *queues[self];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.tasks.empty()) return false;
+    task = q.tasks.front();
+    q.tasks.pop_front();
+    return true;
+}
+
+// From the far end of the victim's block, away from where its owner is working.
+bool WorkPool::steal(unsigned self, size_t &task) {
+    size_t count = queues.size();
+    for (size_t v = 1; v < count; v++) {
+        Queue &q = *queues[(self + v) % count];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.tasks.empty()) continue;
+        task = q.tasks.back();
+        q.tasks.pop_back();
+        stolen++;
+        return true;
+    }
+    return false;
+}
+
+uint64_t WorkPool::Seed(uint64_t base, size_t task) {
+    uint64_t z = base + (static_cast<uint64_t>(task) + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
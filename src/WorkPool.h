@@ -0,0 +1,84 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* Threads that stay up between batches of independent tasks, for
+* evaluating candidates side by side. Run() deals each worker a contiguous
+* block of task indices on its own deque. A worker takes tasks from the
+* front of its own deque and, once that is empty, steals from the back of
+* the others'. Episodes cut short when the car leaves the track take a
+* fraction of the time of full ones, and that would leave cores idle with
+* blocks fixed up front.
+*
+* The calling thread is worker 0, so a pool of one runs everything inline.
+* Tasks are told only their index. Anything random in a task should come
+* from Seed(base, index), which makes results the same whichever worker
+* ran the task and in whatever order.
+*/
+class WorkPool {
+public:
+    /*
+    * threads workers in all, counting the caller (0: one per core).
+    */
+    explicit WorkPool(unsigned threads = 0);
+
+    ~WorkPool();
+
+    WorkPool(const WorkPool &) = delete;
+    WorkPool &operator=(const WorkPool &) = delete;
+
+    unsigned Size() const { return static_cast<unsigned>(queues.size()); }
+
+    /*
+    * Call task(k) for every k in [0, tasks), concurrently, and return when
+    * all calls have. One Run at a time.
+    */
+    void Run(size_t tasks, const std::function<void(size_t)> &task);
+
+    /*
+    * Tasks of the last Run that a worker stole from another one's deque.
+    */
+    size_t Stolen() const { return stolen; }
+
+    /*
+    * splitmix64 of base and task: a well-mixed seed per task that depends
+    * on nothing else.
+    */
+    static uint64_t Seed(uint64_t base, size_t task);
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    void serve(unsigned self);
+    void drain(unsigned self, const std::function<void(size_t)> &task);
+    bool pop(unsigned self, size_t &task);
+    bool steal(unsigned self, size_t &task);
+
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker, 0 is the caller's
+    std::vector<std::thread> workers;
+
+    std::mutex lock; // guards the fields below
+    std::condition_variable wake, done;
+    const std::function<void(size_t)> *job = nullptr;
+    uint64_t generation = 0; // Runs so far, workers wake when it changes
+    size_t busy = 0;         // workers still draining the current Run
+    bool stop = false;
+
+    std::atomic<size_t> stolen{0};
+};
+
+#endif /* WORK_POOL_H */
@@ -1,154 +1,410 @@
 #include <uWS/uWS.h>
+#include <uv.h>
 #include <iostream>
-#include "json.hpp"
-#include "PID.h"
+#include <fstream>
+#include "PIDT.h"
+#include "Telemetry.h"
+#include "FrameScanner.h"
+#include "JsonIndex.h"
+#include "FrameStats.h"
+#include "Clock.h"
+#include "GainSchedule.h"
+#include "ErrorStats.h"
+#include "SpeedControl.h"
+#include "Tuner.h"
+#include "Simulator.h"
+#include "Drive.h"
 #include <math.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+
+// The steering controller. Ki is not used, so the I term is compiled out.
+// It keeps cte statistics since the last Init, printed on disconnect.
+using Steering = Controller<Terms::PD, double, ErrorStatistics<double>, Saturation<double>>;
+
+// What to do with telemetry frames that arrive in the same socket read.
+enum class Coalesce {
+    Off,      // every frame is integrated and answered
+    Drop,     // only the newest frame is integrated and answered, the rest are dropped
+    Integrate // every frame is integrated, only the newest one is answered
+};
+
+// What twiddle tunes.
+enum class Tune {
+    Steering, // the fixed steering gains
+    Speed,    // the speed controller's parameters
+    Schedule  // the steering gains of every row of the gain schedule
+};
+
+struct Options {
+    bool useTwiddle = false;
+    Tune tune = Tune::Steering;
+    int episode = 500;       // frames per twiddle evaluation
+    bool headless = false;   // drive the built-in simulator instead of serving the Unity one
+    bool parallel = false;   // headless twiddle probing every parameter at once
+    unsigned threads = 0;    // workers evaluating the parallel probes, 0 for one per core
+    int branchAt = 0;        // headless episodes start this many frames into the run
+    std::string track;       // headless track centreline, the built-in loop when empty
+    SimConfig sim;
+    Coalesce coalesce = Coalesce::Off;
+    uint64_t deadline = 0;  // ns from arrival to control, 0 for no limit
+    bool rejectLate = false; // skip late, duplicated and out-of-order frames instead of only counting them
+    std::string record;      // file to write the cte trace to, for offline screening
+    bool timed = false;      // scale the D and I terms by the measured frame spacing
+    bool tsc = false;        // stamp frames with the calibrated TSC instead of clock_gettime
+    GainSchedule schedule;   // steering gains by speed, empty to keep the fixed gains
+    std::string saveSchedule = "schedule.txt"; // where --twiddle=schedule writes the tuned table
+};
+
+// Clock frames are stamped with, captured once per frame on arrival
+uint64_t (*frameClock)() = monotonicNanos;
+
+// Per-connection state, attached to the socket as uWS user data.
+struct Connection {
+    explicit Connection(uWS::WebSocket<uWS::SERVER> ws) : ws(ws) {}
+
+    uWS::WebSocket<uWS::SERVER> ws;
+    // Send queue: the static control frames and the reply produced since the last
+    // flush, which sends them in order. A newer reply replaces one not yet sent.
+    std::string_view control[4];
+    size_t control_count = 0;
+    char out[kMaxSteerFrame];  // steer reply buffer, reused for every frame
+    std::string_view reply;    // pending reply, in out or static, empty when there is none
+    uWS::OpCode reply_op = uWS::OpCode::TEXT;
+
+    JsonIndex index;          // reused for frames off the telemetry fast path
+    std::ofstream *trace = nullptr; // cte of every controlled frame, one per line
+
+    FrameStats stats;
+    FrameStamp stamp{};       // the frame being handled
+    FrameStamp reply_stamp{}; // the frame the pending reply answers
+    bool timed = false;
+    FrameTimer timer;         // spacing of controlled frames, for timed updates
+    const GainSchedule *schedule = nullptr;
+
+    // coalescing
+    std::string latest;       // copy of the newest frame not yet handled (Drop)
+    uWS::OpCode latest_op = uWS::OpCode::TEXT;
+    FrameStamp latest_stamp{};
+    bool has_latest = false;
+    bool queued = false;      // waiting for the end of the current socket read
+
+    unsigned long frames = 0;     // "42" frames received
+    unsigned long dropped = 0;    // frames never given to the controller
+    unsigned long unanswered = 0; // frames integrated without a reply of their own
+    unsigned long unsent = 0;     // control frames dropped because the send queue was full
+};
+
+Connection &connection(uWS::WebSocket<uWS::SERVER> ws) {
+    return *static_cast<Connection *>(ws.getUserData());
+}
+
+// Queues a frame with static storage, sent ahead of the reply. Dropped (and
+// counted) when the queue is full.
+void enqueue(Connection &conn, std::string_view frame) {
+    if (conn.control_count == std::size(conn.control)) {
+        conn.unsent++;
+        return;
+    }
+    conn.control[conn.control_count++] = frame;
+}
+
+// Sets the reply for the current frame, msg must outlive the next flush.
+void reply(Connection &conn, std::string_view msg, uWS::OpCode opCode = uWS::OpCode::TEXT) {
+    if (!conn.reply.empty()) conn.unanswered++;
+    conn.reply = msg;
+    conn.reply_op = opCode;
+    conn.reply_stamp = conn.stamp;
+}
+
+// Sends everything queued for the connection back to back, once per callback or burst.
+// uWS 0.14 has no vectored write, it gets the frames in one go and writes them
+// behind each other in its own buffer whenever the socket is busy.
+void flush(Connection &conn) {
+    for (size_t k = 0; k < conn.control_count; k++) {
+        conn.ws.send(conn.control[k].data(), conn.control[k].size(), uWS::OpCode::TEXT);
+    }
+    conn.control_count = 0;
+    if (!conn.reply.empty()) {
+        conn.ws.send(conn.reply.data(), conn.reply.size(), conn.reply_op);
+        conn.reply = {};
+        conn.stats.Replied(conn.reply_stamp, frameClock());
+    }
+}
 
-// for convenience
-using json = nlohmann::json;
-
-// Checks if the SocketIO event has JSON data.
-// If there is data the JSON object in string format will be returned,
-// else the empty string "" will be returned.
-std::string hasData(std::string s) {
-    auto found_null = s.find("null");
-    auto b1 = s.find_first_of("[");
-    auto b2 = s.find_last_of("]");
-    if (found_null != std::string::npos) {
-        return "";
-    } else if (b1 != std::string::npos && b2 != std::string::npos) {
-        return s.substr(b1, b2 - b1 + 1);
-    }
-    return "";
-}
-
-void move(uWS::WebSocket<uWS::SERVER> ws, char *data, size_t length, uWS::OpCode opCode, bool print, PID &pid) {
-    auto s = hasData(std::string(data).substr(0, length));
-    if (s != "") {
-        auto j = json::parse(s);
-        std::string event = j[0].get<std::string>();
-        if (event == "telemetry") {
-            // j[1] is the data JSON object
-            double cte = std::stod(j[1]["cte"].get<std::string>());
-            double speed = std::stod(j[1]["speed"].get<std::string>());
-            double angle = std::stod(j[1]["steering_angle"].get<std::string>());
-            double steer_value;
-
-            steer_value = pid.UpdateError(cte);
-
-            // DEBUG
-            if (print)
-                std::cout << "CTE: " << cte << " Steering Value: " << steer_value << std::endl;
-
-            json msgJson;
-            msgJson["steering_angle"] = steer_value;
-            msgJson["throttle"] = 1;
-
-            if ((fabs(cte) >= 0.4 | fabs(angle) > 5 | steer_value >= 0.5) && speed >= 28.0)
-                msgJson["throttle"] = -1; // brake
-
-            auto msg = "42[\"steer\"," + msgJson.dump() + "]";
-            if (print) std::cout << msg << std::endl;
-            ws.send(msg.data(), msg.length(), uWS::OpCode::TEXT);
+// The controller step, shared by the text and binary protocols.
+// dt is the spacing to the previous frame in nominal periods, 0 for a fixed step.
+Actuation control(const TelemetryView &t, double dt, bool print, Steering &pid, SpeedControl &speed_control,
+                  const GainSchedule *schedule) {
+    Actuation a = drive(pid, speed_control, schedule, t.cte, t.speed, dt);
+
+    // DEBUG
+    if (print)
+        std::cout << "CTE: " << t.cte << " Steering Value: " << a.steering_angle << std::endl;
+
+    return a;
+}
+
+void steer(uWS::WebSocket<uWS::SERVER> ws, const TelemetryView &t, bool print, Steering &pid, SpeedControl &speed) {
+    auto &conn = connection(ws);
+    Actuation a = control(t, conn.timed ? conn.timer.Step(conn.stamp.arrival) : 0, print, pid, speed, conn.schedule);
+    if (conn.trace) *conn.trace << t.cte << '\n';
+    reply(conn, std::string_view(conn.out, encodeSteer(conn.out, sizeof(conn.out), a.steering_angle, a.throttle)));
+    if (print) std::cout << conn.reply << std::endl;
+}
+
+void steerBinary(uWS::WebSocket<uWS::SERVER> ws, const TelemetryView &t, uint64_t seq, bool print, Steering &pid,
+                 SpeedControl &speed) {
+    auto &conn = connection(ws);
+    Actuation a = control(t, conn.timed ? conn.timer.Step(conn.stamp.arrival) : 0, print, pid, speed, conn.schedule);
+    if (conn.trace) *conn.trace << t.cte << '\n';
+    size_t length = encodeBinarySteer(conn.out, sizeof(conn.out), seq, a.steering_angle, a.throttle);
+    reply(conn, std::string_view(conn.out, length), uWS::OpCode::BINARY);
+}
+
+void move(uWS::WebSocket<uWS::SERVER> ws, std::string_view frame, uWS::OpCode opCode, bool print, Steering &pid,
+          SpeedControl &speed) {
+    if (opCode == uWS::OpCode::BINARY) {
+        Telemetry t;
+        uint64_t seq;
+        if (decodeBinaryTelemetry(frame, t, seq) && connection(ws).stats.Sender(seq))
+            steerBinary(ws, TelemetryView(t), seq, print, pid, speed);
+        return;
+    }
+
+    // Checks if the SocketIO event has JSON data, s is a view into the uWS
+    // receive buffer and is only valid for the current callback.
+    auto scan = scanFrame(frame);
+    if (scan.kind == FrameKind::Data) {
+        auto s = scan.array;
+        auto &index = connection(ws).index;
+        Telemetry t;
+        std::string_view object;
+        if (decodeTelemetry(s, t, &object)) {
+            steer(ws, TelemetryView(t, object, index), print, pid, speed);
+            return;
+        }
+
+        // not the telemetry layout we know, index the frame and pull the fields on demand
+        JsonIndex::Value root, event, data, v;
+        std::string_view name;
+        if (!index.Build(s) || !index.Root(root) || !index.Element(root, 0, event) || !JsonIndex::String(event, name))
+            return;
+        if (name == "telemetry" && index.Element(root, 1, data)) {
+            if (index.Field(data, "cte", v) && JsonIndex::Number(v, t.cte) &&
+                index.Field(data, "speed", v) && JsonIndex::Number(v, t.speed) &&
+                index.Field(data, "steering_angle", v) && JsonIndex::Number(v, t.steering_angle))
+                steer(ws, TelemetryView(t, data.text, index), print, pid, speed);
         }
     } else {
         // Manual driving
-        std::string msg = "42[\"manual\",{}]";
-        ws.send(msg.data(), msg.length(), uWS::OpCode::TEXT);
+        reply(connection(ws), kManualFrame);
+    }
+}
+
+// Where twiddle starts: the steering gains p, the speed controller's parameters,
+// or Kp Ki Kd of every schedule row in turn. Gains of terms Steering compiles
+// out get no step, so they are never tried.
+struct TuningStart {
+    std::vector<double> params, steps;
+    double tolerance;
+};
+
+TuningStart tuningStart(const double p[], SpeedControl &speed, const GainSchedule &schedule, Tune tune) {
+    TuningStart start;
+    if (tune == Tune::Speed) {
+        for (int k = 0; k < SpeedControl::kParams; k++) start.params.push_back(speed.Param(k));
+        start.steps = {0.05, 0.0005, 5, 2, 5};
+    } else if (tune == Tune::Schedule) {
+        for (size_t r = 0; r < schedule.Size(); r++) {
+            const Gains &g = schedule.Row(r);
+            start.params.insert(start.params.end(), {g.Kp, g.Ki, g.Kd});
+            for (int k = 0; k < 3; k++) start.steps.push_back(Steering::Uses(k) ? 1 : 0);
+        }
+    } else {
+        start.params.assign(p, p + 3);
+        for (int k = 0; k < 3; k++) start.steps.push_back(Steering::Uses(k) ? 1 : 0);
+    }
+    // stop once the steps are down to a tenth of where they started (0.2 for the steering gains)
+    start.tolerance = 0;
+    for (double s : start.steps) start.tolerance += 0.1 * s;
+    return start;
+}
+
+// Restarts the controllers with a twiddle candidate
+void applyCandidate(const std::vector<double> &candidate, Tune tune, double p[], Steering &pid,
+                    SpeedControl &speed, GainSchedule &schedule) {
+    if (tune == Tune::Speed) {
+        for (int k = 0; k < SpeedControl::kParams; k++) speed.Param(k) = candidate[k];
+    } else if (tune == Tune::Schedule) {
+        for (size_t r = 0; r < schedule.Size(); r++)
+            schedule.SetRow(r, {candidate[3 * r], candidate[3 * r + 1], candidate[3 * r + 2]});
+    } else {
+        for (int k = 0; k < 3; k++) p[k] = candidate[k];
+    }
+    pid.Init(p[0], p[1], p[2]);
+    speed.Reset();
+}
+
+void printCandidate(const std::vector<double> &candidate, Tune tune, const GainSchedule &schedule) {
+    const char *names[] = {"Kp", "Ki", "Kd"};
+    if (tune == Tune::Schedule) {
+        for (size_t r = 0; r < schedule.Size(); r++) {
+            std::cout << schedule.Speed0() + r * schedule.Step() << " mph: Kp = " << candidate[3 * r]
+                      << ", Ki = " << candidate[3 * r + 1] << ", Kd = " << candidate[3 * r + 2] << std::endl;
+        }
+        return;
+    }
+    for (size_t k = 0; k < candidate.size(); k++) {
+        std::cout << (k ? ", " : "") << (tune == Tune::Speed ? SpeedControl::ParamName(k) : names[k]) << " = "
+                  << candidate[k];
     }
+    std::cout << std::endl;
 }
 
-void run(double p[], bool useTwiddle) {
-    PID pid;
+// What twiddle minimizes: error per mph, whatever is tuned. The target speed
+// drops with steering, so on plain error steering gains would win by
+// oversteering to slow the car down; faster laps have to pay for their error.
+double tuningCost(double total_error, double mean_speed) {
+    return total_error / std::max(mean_speed, 1.0);
+}
+
+// A tuned schedule goes to a file --schedule can load.
+void saveSchedule(const GainSchedule &schedule, const std::string &path) {
+    if (schedule.Save(path)) {
+        std::cout << "schedule written to " << path << std::endl;
+    } else {
+        std::cerr << "can't write schedule " << path << std::endl;
+    }
+}
+
+void run(double p[], const Options &opts) {
+    Steering pid;
     pid.Init(p[0], p[1], p[2]);
+    SpeedControl speed;
+
+    // the default loop, so the coalescing check below runs on the same loop as uWS
+    uWS::Hub h(0, true);
+    int i = 0;
+    bool useTwiddle = opts.useTwiddle;
+
+    Tune tune = opts.tune;
+    GainSchedule schedule = opts.schedule; // rows change under --twiddle=schedule
+    TuningStart start = tuningStart(p, speed, schedule, tune);
+    Tuner tuner(start.params, start.steps, start.tolerance);
+    auto apply = [&pid, &speed, &p, &schedule, tune](const std::vector<double> &candidate) {
+        applyCandidate(candidate, tune, p, pid, speed, schedule);
+    };
+
+    // Twiddle evaluation and control for one "42" or binary frame. An episode is
+    // opts.episode frames from a reset, cut short once it can't beat the best.
+    auto handle = [&pid, &speed, &i, &tuner, &apply, &useTwiddle, &opts, &schedule, tune](
+            uWS::WebSocket<uWS::SERVER> ws, std::string_view frame, uWS::OpCode opCode) {
+        double err = tuningCost(pid.TotalError(), speed.MeanSpeed());
+
+        // if current error bigger than best_error -> stop
+        if (i > opts.episode / 5 && err > tuner.BestCost()) i = opts.episode;
+
+        //twiddle
+        if (i >= opts.episode && useTwiddle) {
+            i = 0;
+            int it = tuner.Iteration();
+            tuner.Tell(err);
+
+            if (tuner.Iteration() != it || tuner.Done()) {
+                std::cout << "iteration: " << it << ", error: " << err << ", best_err: " << tuner.BestCost()
+                          << ", sum_dp: " << tuner.StepSum() << std::endl;
+                printCandidate(tuner.Best(), tune, schedule);
+            }
+
+            if (tuner.Done()) {
+                // finish!!!
+                useTwiddle = false;
+                apply(tuner.Best());
+                if (tune == Tune::Schedule) saveSchedule(schedule, opts.saveSchedule);
+            } else {
+                apply(tuner.Ask());
+            }
+        }
 
-    uWS::Hub h;
-    int i = 0, it = 0, par = 0;
-    double dp[] = {1, 1, 1};
-    int state = 0;
-    double best_err = 0;
-
-    h.onMessage(
-            [&pid, &i, &dp, &state, &best_err, &it, &par, &useTwiddle, &p](uWS::WebSocket<uWS::SERVER> ws, char *data,
-                                                                           size_t length, uWS::OpCode opCode) {
-                // "42" at the start of the message means there's a websocket message event.
-                // The 4 signifies a websocket message
-                // The 2 signifies a websocket event
-                if (length && length > 2 && data[0] == '4' && data[1] == '2') {
-                    double tolerance = 0.2;
-                    int n = 500; //max steps per iteration
-
-                    double err = pid.TotalError();
-
-                    // if current error bigger than best_error -> stop
-                    if (i > 100 && err > best_err && state > 0) i = n + 1;
-
-                    //twiddle
-                    if (i >= n && useTwiddle) {
-                        i = 0;
-
-                        double sum_dp = std::accumulate(std::begin(dp), std::end(dp), 0.0, std::plus<double>());
-
-                        if (state < 2 & par == 0) { //new iteration
-                            std::cout << "iteration: " << it++ << ", error: " << err << ", best_err: " << best_err
-                                      << ", sum_dp: " << sum_dp << std::endl;
-                            std::cout << "Kp = " << p[0] << ", Ki = " << p[1] << ", Kd = " << p[2] << std::endl;
-                            //std::cout << "dp0 = " << dp[0] << ", dp1 = " << dp[1] << ", dp2 = " << dp[2] << std::endl;
-                        }
-
-                        if (sum_dp > tolerance) {
-                            //std::cout << "state = " << state << ", par = " << par << std::endl;
-                            switch (state) { //state machine
-                                case 0: // init, one time
-                                    best_err = err;
-                                    state = 1;
-                                    p[par] += dp[par];
-                                    break;
-                                case 1:
-                                    if (err < best_err) {
-                                        best_err = err;
-                                        dp[par] *= 1.1;
-
-                                        par = (par + 1) % 3;
-                                        if (par == 1) par++; // Ki is constantly 0
-
-                                        p[par] += dp[par];
-                                    } else {
-                                        p[par] -= 2. * dp[par];
-                                        state = 2;
-                                    }
-                                    break;
-                                case 2:
-                                    if (err < best_err) {
-                                        best_err = err;
-                                        dp[par] *= 1.1;
-                                    } else {
-                                        p[par] += dp[par];
-                                        dp[par] *= 0.9;
-                                    }
-                                    par = (par + 1) % 3;
-                                    if (par == 1) par++; // Ki is constantly 0
-
-                                    state = 1;
-                                    p[par] += dp[par];
-                                    break;
-                            }
-
-                            pid.Init(p[0], p[1], p[2]);
-                        } else {
-                            // finish!!!
-                            useTwiddle = false;
-                        }
-                    }
-
-                    if (i++ == 0) {
-                        std::string reset_msg = "42[\"reset\", {}]";
-                        ws.send(reset_msg.data(), reset_msg.length(), uWS::OpCode::TEXT);
-                    }
-
-                    move(ws, data, length, opCode, !useTwiddle, pid);
-                }
-            });
+        if (i++ == 0) {
+            enqueue(connection(ws), kResetFrame);
+        }
+
+        move(ws, frame, opCode, !useTwiddle, pid, speed);
+    };
+
+    // Drops the frame if it waited past the deadline, else hands it on
+    auto process = [&handle](Connection &conn, std::string_view frame, uWS::OpCode opCode, const FrameStamp &stamp,
+                             uint64_t now) {
+        if (!conn.stats.Admit(stamp, now)) return;
+        conn.stamp = stamp;
+        handle(conn.ws, frame, opCode);
+    };
+
+    // Connections holding frames or replies until the current socket read is done.
+    // uWS dispatches every frame of a read before the loop reaches its check phase,
+    // so a check handle sees each burst as a whole.
+    std::vector<Connection *> pending;
+    auto drain = [&pending, &process]() {
+        uint64_t now = frameClock();
+        for (auto *conn : pending) {
+            if (conn->has_latest) {
+                conn->has_latest = false;
+                process(*conn, conn->latest, conn->latest_op, conn->latest_stamp, now);
+            }
+            flush(*conn);
+            conn->queued = false;
+        }
+        pending.clear();
+    };
+    uv_check_t check;
+    if (opts.coalesce != Coalesce::Off) {
+        uv_check_init(uv_default_loop(), &check);
+        check.data = &drain;
+        uv_check_start(&check, [](uv_check_t *c) { (*static_cast<decltype(drain) *>(c->data))(); });
+    }
+
+    h.onMessage([&process, &pending, &opts](uWS::WebSocket<uWS::SERVER> ws, char *data, size_t length,
+                                         uWS::OpCode opCode) {
+        // "42" at the start of the message means there's a websocket message event.
+        // The 4 signifies a websocket message
+        // The 2 signifies a websocket event
+        // Binary frames come from local harnesses speaking the fixed layout in Telemetry.h
+        if (opCode == uWS::OpCode::BINARY || (length && length > 2 && data[0] == '4' && data[1] == '2')) {
+            // uWS payloads are not NUL-terminated, so the frame is bounded by length
+            std::string_view frame(data, length);
+            auto &conn = connection(ws);
+            conn.frames++;
+            uint64_t now = frameClock();
+            FrameStamp stamp = conn.stats.Stamp(now);
+
+            if (opts.coalesce == Coalesce::Off) {
+                process(conn, frame, opCode, stamp, now);
+                flush(conn);
+                return;
+            }
+
+            if (opts.coalesce == Coalesce::Drop) {
+                // data only lives for this callback, keep a copy of the newest frame
+                if (conn.has_latest) conn.dropped++;
+                conn.latest.assign(frame);
+                conn.latest_op = opCode;
+                conn.latest_stamp = stamp;
+                conn.has_latest = true;
+            } else {
+                process(conn, frame, opCode, stamp, now);
+            }
+            if (!conn.queued) {
+                conn.queued = true;
+                pending.push_back(&conn);
+            }
+        }
+    });
 
     // We don't need this since we're not using HTTP but if it's removed the program
     // doesn't compile :-(
@@ -162,11 +418,32 @@ void run(double p[], bool useTwiddle) {
         }
     });
 
-    h.onConnection([&h](uWS::WebSocket<uWS::SERVER> ws, uWS::HttpRequest req) {
+    std::ofstream trace;
+    if (!opts.record.empty()) {
+        trace.open(opts.record);
+        trace.precision(17);
+    }
+
+    h.onConnection([&h, &opts, &trace, &schedule](uWS::WebSocket<uWS::SERVER> ws, uWS::HttpRequest req) {
+        auto *conn = new Connection(ws);
+        if (trace.is_open()) conn->trace = &trace;
+        conn->timed = opts.timed;
+        if (!schedule.Empty()) conn->schedule = &schedule;
+        conn->stats.deadline = opts.deadline;
+        conn->stats.reject = opts.rejectLate;
+        ws.setUserData(conn);
         std::cout << "Connected!!!" << std::endl;
     });
 
-    h.onDisconnection([&h](uWS::WebSocket<uWS::SERVER> ws, int code, char *message, size_t length) {
+    h.onDisconnection([&h, &pending, &pid](uWS::WebSocket<uWS::SERVER> ws, int code, char *message, size_t length) {
+        auto *conn = &connection(ws);
+        std::cout << "Frames: " << conn->frames << ", dropped: " << conn->dropped
+                  << ", unanswered: " << conn->unanswered << ", unsent control frames: " << conn->unsent << ", "
+                  << conn->stats << std::endl;
+        std::cout << pid.Get<ErrorStatistics<double>>().stats << std::endl;
+        pending.erase(std::remove(pending.begin(), pending.end(), conn), pending.end());
+        delete conn;
+        ws.setUserData(nullptr);
         ws.close();
         std::cout << "Disconnected" << std::endl;
     });
@@ -181,11 +458,177 @@ void run(double p[], bool useTwiddle) {
     h.run();
 }
 
+// The same controllers and tuning against the built-in simulator, as fast as it runs.
+int runHeadless(double p[], const Options &opts) {
+    Track track = opts.track.empty() ? Track::Loop() : Track::Load(opts.track);
+    if (track.Size() == 0) {
+        std::cerr << "can't read track " << opts.track << std::endl;
+        return 1;
+    }
 
-int main() {
+    SpeedControl base_speed;
+    Tune tune = opts.tune;
+
+    // Where every episode starts: the start line, or --branch-at frames into a run
+    // with the starting controllers. That lead-in is driven once and each episode
+    // continues from a copy of its state.
+    Simulator lead_sim(track, opts.sim);
+    Steering lead_pid;
+    lead_pid.Init(p[0], p[1], p[2]);
+    SpeedControl lead_speed = base_speed;
+    EpisodeResult lead = runEpisode(lead_sim, lead_pid, lead_speed, opts.branchAt,
+                                    opts.schedule.Empty() ? nullptr : &opts.schedule);
+    if (lead.off_track) {
+        std::cerr << "the starting controllers leave the track after " << lead.frames << " frames" << std::endl;
+        return 1;
+    }
+    const Branch<Steering> branch{lead_sim, lead_pid.Snapshot(), lead_speed.Snapshot()};
+
+    // One episode from the branch point, each call with its own controllers and car.
+    // Every episode replays the same cte noise from the configured seed, so
+    // candidates are compared on equal terms and whichever worker runs one
+    // gets the same cost.
+    auto evaluate = [&](const std::vector<double> &candidate, EpisodeResult *result) {
+        double q[] = {p[0], p[1], p[2]};
+        Steering pid;
+        SpeedControl speed = base_speed;
+        GainSchedule schedule = opts.schedule;
+        applyCandidate(candidate, tune, q, pid, speed, schedule);
+        Simulator sim = branch.sim;
+        pid.Restore(branch.steering);
+        speed.Restore(branch.speed);
+        EpisodeResult r = runEpisode(sim, pid, speed, opts.episode, schedule.Empty() ? nullptr : &schedule);
+        if (result) *result = r;
+        return tuningCost(r.total_error, r.mean_speed);
+    };
+    auto cost = [&evaluate](const std::vector<double> &candidate) { return evaluate(candidate, nullptr); };
+
+    TuningStart start = tuningStart(p, base_speed, opts.schedule, tune);
+    std::vector<double> best = start.params;
+    if (opts.useTwiddle) {
+        auto t0 = std::chrono::steady_clock::now();
+        int evaluations = 0;
+        if (opts.parallel) {
+            // episodes that leave the track end early, the pool keeps the workers busy meanwhile
+            WorkPool pool(opts.threads);
+            ParallelTuner tuner(start.params, start.steps, start.tolerance);
+            tuner.Run(cost, 100000, pool);
+            best = tuner.Best();
+            std::cout << "rounds: " << tuner.Iteration();
+        } else {
+            Tuner tuner(start.params, start.steps, start.tolerance);
+            tuner.Run([&cost, &evaluations](const std::vector<double> &c) {
+                evaluations++;
+                return cost(c);
+            }, 100000);
+            best = tuner.Best();
+            std::cout << "evaluations: " << evaluations;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        std::cout << ", " << std::chrono::duration<double>(t1 - t0).count() << " s" << std::endl;
+        printCandidate(best, tune, opts.schedule);
+        if (tune == Tune::Schedule) {
+            GainSchedule tuned = opts.schedule;
+            for (size_t r = 0; r < tuned.Size(); r++)
+                tuned.SetRow(r, {best[3 * r], best[3 * r + 1], best[3 * r + 2]});
+            saveSchedule(tuned, opts.saveSchedule);
+        }
+    }
+
+    EpisodeResult r;
+    double c = evaluate(best, &r);
+    std::cout << "frames: " << r.frames << (r.off_track ? " (off track)" : "") << ", error: " << r.total_error
+              << ", cost: " << c << ", mean speed: " << r.mean_speed << " mph, distance: " << r.distance << " m of a "
+              << track.length << " m lap" << std::endl;
+    return 0;
+}
+
+
+int main(int argc, char *argv[]) {
     double p[] = {0.3, 0.000, 3.5}; // yes, I don't use Ki
 
-    run(p, false); // (parameters, use twiddle)
+    Options opts;
+    for (int a = 1; a < argc; a++) {
+        std::string_view arg = argv[a];
+        if (arg == "--twiddle") {
+            opts.useTwiddle = true;
+        } else if (arg == "--twiddle=speed") {
+            opts.useTwiddle = true;
+            opts.tune = Tune::Speed;
+        } else if (arg == "--twiddle=schedule") {
+            opts.useTwiddle = true;
+            opts.tune = Tune::Schedule;
+        } else if (arg.substr(0, 16) == "--save-schedule=") {
+            opts.saveSchedule = std::string(arg.substr(16));
+        } else if (arg == "--coalesce=drop") {
+            opts.coalesce = Coalesce::Drop;
+        } else if (arg == "--coalesce=integrate") {
+            opts.coalesce = Coalesce::Integrate;
+        } else if (arg.substr(0, 14) == "--deadline-ms=") {
+            // NaN fails the first test; a value past the uint64_t range can't be converted
+            double ns = std::stod(std::string(arg.substr(14))) * 1e6;
+            if (!(ns > 0) || ns >= 1.8e19) {
+                std::cerr << "--deadline-ms must be a positive number of milliseconds" << std::endl;
+                return 1;
+            }
+            opts.deadline = static_cast<uint64_t>(ns);
+        } else if (arg == "--headless") {
+            opts.headless = true;
+        } else if (arg == "--parallel") {
+            opts.parallel = true;
+        } else if (arg.substr(0, 12) == "--branch-at=") {
+            opts.branchAt = std::max(std::stoi(std::string(arg.substr(12))), 0);
+        } else if (arg.substr(0, 10) == "--threads=") {
+            opts.threads = static_cast<unsigned>(std::max(std::stoi(std::string(arg.substr(10))), 0));
+        } else if (arg.substr(0, 8) == "--track=") {
+            opts.track = std::string(arg.substr(8));
+        } else if (arg.substr(0, 12) == "--sim-delay=") {
+            opts.sim.delay = std::max(std::stoi(std::string(arg.substr(12))), 0);
+        } else if (arg.substr(0, 12) == "--sim-noise=") {
+            opts.sim.cte_noise = std::stod(std::string(arg.substr(12)));
+        } else if (arg.substr(0, 17) == "--episode-frames=") {
+            opts.episode = std::max(std::stoi(std::string(arg.substr(17))), 1);
+        } else if (arg == "--reject-late") {
+            opts.rejectLate = true;
+        } else if (arg == "--timed") {
+            opts.timed = true;
+        } else if (arg == "--tsc-clock") {
+            opts.tsc = true;
+        } else if (arg.substr(0, 9) == "--record=") {
+            opts.record = std::string(arg.substr(9));
+        } else if (arg.substr(0, 11) == "--schedule=") {
+            if (!opts.schedule.Load(std::string(arg.substr(11)))) {
+                std::cerr << "can't read gain schedule " << arg.substr(11) << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "usage: pid [--twiddle[=speed|schedule]] [--save-schedule=FILE] [--episode-frames=N]"
+                      << " [--coalesce=drop|integrate] [--deadline-ms=N] [--reject-late] [--record=trace.txt]"
+                      << " [--timed] [--tsc-clock] [--schedule=gains.txt] [--headless [--parallel [--threads=N]]"
+                      << " [--branch-at=N] [--track=xy.txt] [--sim-delay=N] [--sim-noise=M]]" << std::endl;
+            return 1;
+        }
+    }
+    if (opts.useTwiddle && opts.tune == Tune::Steering && !opts.schedule.Empty()) {
+        // the schedule would overwrite every candidate's gains on every frame
+        std::cerr << "--twiddle tunes the fixed gains, which --schedule replaces; use --twiddle=schedule" << std::endl;
+        return 1;
+    }
+    if (opts.tune == Tune::Schedule && opts.schedule.Empty()) {
+        // no table to start from: the fixed gains every 10 mph up to 50
+        opts.schedule = GainSchedule(0, 10, std::vector<Gains>(6, Gains{p[0], p[1], p[2]}));
+    }
+    if (opts.tsc) {
+        if (TscClock::Instance().Available()) {
+            frameClock = [] { return TscClock::Instance().Nanos(); };
+        } else {
+            std::cerr << "no invariant TSC, using clock_gettime" << std::endl;
+        }
+    }
+
+    if (opts.headless) return runHeadless(p, opts);
+
+    run(p, opts);
 
     return 0;
 }